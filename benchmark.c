@@ -1,289 +1,516 @@
-
 /**
  * @file benchmark.c
- * @brief Performance benchmark comparing original vs optimized YScanF
+ * @brief Benchmark harness for yscanf.h and the standard parsers
+ *
+ * One binary is built per parser; the file compiles as C or C++. The
+ * yscanf variants differ only in the overflow policy of their integer reads:
+ *
+ *   cc  -O2 -DBENCH_YSCANF           benchmark.c -o bench_yscanf
+ *   cc  -O2 -DBENCH_YSCANF_FAIL      benchmark.c -o bench_yscanf_fail
+ *   cc  -O2 -DBENCH_YSCANF_UNCHECKED benchmark.c -o bench_yscanf_unchecked
+ *   cc  -O2 -DBENCH_SCANF      benchmark.c -o bench_scanf
+ *   cc  -O2 -DBENCH_STRTO      benchmark.c -o bench_strto
+ *   c++ -O2 -std=c++17 -x c++ -DBENCH_CIN        benchmark.c -o bench_cin
+ *   c++ -O2 -std=c++17 -x c++ -DBENCH_FROM_CHARS benchmark.c -o bench_from_chars
+ *
+ * `./format_code.sh benchmark` builds all of them, generates the corpora and
+ * writes the combined results to benchmark_results.csv.
+ *
+ * Usage:
+ *   bench --gen DIR [--scale N]
+ *   bench [--runs N] [--warmup N] [--pipe] [--json] [--no-header] [--kernel NAME] [--format] CORPUS...
+ *   bench --kernels
+ *
+ * Every run is a forked child, so parser state (static buffers, stdin, EOF
+ * flags) starts fresh. The child reads the corpus from stdin, either the
+ * file itself or a pipe fed by a separate process, and times only the parse
+ * with CLOCK_MONOTONIC. The corpus kind comes from its file name prefix:
+ * int*, float* or str*. Results are one CSV row (or JSON line) per corpus
+ * with median, p99 and min times, bytes/sec, ns/token and a checksum that
+ * must agree across parsers.
+ *
+ * The yscanf variants take --kernel byte|swar|sse2|avx2|avx512|neon to force
+ * one scan kernel variant (the parser column then reads e.g. yscanf/avx2);
+ * --kernels lists the ones this binary and CPU can run. Build with
+ * -DYSCANF_DISPATCH, without -march, to have all of them in one binary.
+ * --format reads each token through yscanf("%lld") and friends rather than
+ * the typed reads (parser yscanf/format), so the difference between the two
+ * is the per-call cost of the format cache lookup and the compiled program.
  */
 
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <time.h>
-#include <sys/time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#define BENCH_MAX_RUNS 1000
+#define BENCH_STR_MAX (1 << 16)
+
+enum { KIND_INT, KIND_FLOAT, KIND_STR };
+
+/* What a child run reports back to the parent */
+struct bench_result {
+    long long ns;
+    unsigned long long tokens;
+    unsigned long long checksum;
+    int ok;
+};
+
+static char str_buf[BENCH_STR_MAX];
 
-/* Include both versions for comparison */
+static unsigned long long double_bits(double x) {
+    unsigned long long b;
+    memcpy(&b, &x, sizeof(b));
+    return b;
+}
+
+/* ============================================================================
+ * PARSER VARIANTS
+ *
+ * Each variant provides read_ll(), read_double() and read_str(), returning 1
+ * per token and 0 at end of input.
+ * ============================================================================ */
+
+#if defined(BENCH_YSCANF) || defined(BENCH_YSCANF_FAIL) || defined(BENCH_YSCANF_UNCHECKED)
 #include "yscanf.h"
+#if defined(BENCH_YSCANF_FAIL)
+#define BENCH_NAME "yscanf_fail"
+#define BENCH_OVF YOVF_FAIL
+#elif defined(BENCH_YSCANF_UNCHECKED)
+#define BENCH_NAME "yscanf_unchecked"
+#define BENCH_OVF YOVF_UNCHECKED
+#else
+#define BENCH_NAME "yscanf"
+#define BENCH_OVF YOVF_SATURATE
+#endif
+
+/* --kernel NAME forces one scan kernel variant; build with -DYSCANF_DISPATCH for all of them */
+#define BENCH_KERNELS 1
+static int bench_set_kernel(const char *name) {
+    for (int v = 0; v < YKERN_COUNT; v++)
+        if (!strcmp(name, ykernel_name(v))) return ykernel_select(v);
+    return 0;
+}
+
+/* --format reads every token through yscanf() instead, to time the format cache */
+#define BENCH_FORMAT 1
+static int bench_format = 0;
+
+static void bench_begin(void) {}
+static int read_ll(long long *x) { return bench_format ? yscanf("%lld", x) == 1 : yread_ll_ovf(x, BENCH_OVF); }
+static int read_double(double *x) { return bench_format ? yscanf("%lf", x) == 1 : yread_double_ok(x); }
+static int read_str(char *s) { return bench_format ? yscanf("%65535s", s) == 1 : yread_str_ok(s); }
 
-#define BENCHMARK_SIZE 1000000
-#define ITERATIONS 10
+#elif defined(BENCH_SCANF)
+#define BENCH_NAME "scanf"
 
-/* Timing utilities */
-static double get_time(void) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_sec + tv.tv_usec / 1000000.0;
+static void bench_begin(void) {}
+static int read_ll(long long *x) { return scanf("%lld", x) == 1; }
+static int read_double(double *x) { return scanf("%lf", x) == 1; }
+static int read_str(char *s) { return scanf("%65535s", s) == 1; }
+
+#elif defined(BENCH_CIN)
+#define BENCH_NAME "cin"
+#include <iostream>
+
+static void bench_begin(void) {
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+}
+static int read_ll(long long *x) { return !!(std::cin >> *x); }
+static int read_double(double *x) { return !!(std::cin >> *x); }
+static int read_str(char *s) {
+    std::cin.width(BENCH_STR_MAX);
+    return !!(std::cin >> s);
 }
 
-/* Generate test data */
-static void generate_test_data(const char *filename, int size) {
-    FILE *fp = fopen(filename, "w");
-    if (!fp) {
-        perror("Failed to create test data");
-        exit(1);
+#elif defined(BENCH_STRTO) || defined(BENCH_FROM_CHARS)
+#if defined(BENCH_FROM_CHARS)
+#define BENCH_NAME "from_chars"
+#include <charconv>
+#else
+#define BENCH_NAME "strto"
+#endif
+
+/* The whole input is read into memory first; that read is part of the timing */
+static char *in_ptr, *in_end;
+
+static void bench_begin(void) {
+    size_t cap = 1 << 20, len = 0;
+    char *buf = (char *)malloc(cap + 1);
+    for (;;) {
+        if (len == cap) buf = (char *)realloc(buf, (cap *= 2) + 1);
+        size_t n = fread(buf + len, 1, cap - len, stdin);
+        if (!n) break;
+        len += n;
     }
-    
-    /* Generate mixed data: integers, floats, strings */
-    for (int i = 0; i < size; i++) {
-        fprintf(fp, "%d %.6f string%d ", i, (double)i * 1.5, i);
-        if (i % 10 == 0) fprintf(fp, "\n");
+    buf[len] = 0;
+    in_ptr = buf;
+    in_end = buf + len;
+}
+
+static int is_space(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+static int skip_space(void) {
+    while (in_ptr < in_end && is_space(*in_ptr)) in_ptr++;
+    return in_ptr < in_end;
+}
+
+#if defined(BENCH_FROM_CHARS)
+static int read_ll(long long *x) {
+    if (!skip_space()) return 0;
+    auto r = std::from_chars(in_ptr, in_end, *x);
+    if (r.ec != std::errc()) return 0;
+    in_ptr = (char *)r.ptr;
+    return 1;
+}
+static int read_double(double *x) {
+    if (!skip_space()) return 0;
+#if defined(__cpp_lib_to_chars)
+    auto r = std::from_chars(in_ptr, in_end, *x);
+    if (r.ec != std::errc()) return 0;
+    in_ptr = (char *)r.ptr;
+#else
+    char *e;
+    *x = strtod(in_ptr, &e);
+    if (e == in_ptr) return 0;
+    in_ptr = e;
+#endif
+    return 1;
+}
+#else
+static int read_ll(long long *x) {
+    char *e;
+    *x = strtoll(in_ptr, &e, 10);
+    if (e == in_ptr) return 0;
+    in_ptr = e;
+    return 1;
+}
+static int read_double(double *x) {
+    char *e;
+    *x = strtod(in_ptr, &e);
+    if (e == in_ptr) return 0;
+    in_ptr = e;
+    return 1;
+}
+#endif
+
+static int read_str(char *s) {
+    if (!skip_space()) return 0;
+    char *p = in_ptr;
+    while (p < in_end && !is_space(*p)) p++;
+    memcpy(s, in_ptr, p - in_ptr);
+    s[p - in_ptr] = 0;
+    in_ptr = p;
+    return 1;
+}
+
+#else
+#error "define one of BENCH_YSCANF3, BENCH_YSCANF2, BENCH_SCANF, BENCH_STRTO, BENCH_CIN, BENCH_FROM_CHARS"
+#endif
+
+/* ============================================================================
+ * TIMING
+ * ============================================================================ */
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Parses all of stdin; runs in the child */
+static struct bench_result parse_stdin(int kind) {
+    struct bench_result res;
+    memset(&res, 0, sizeof(res));
+
+    long long start = now_ns();
+    bench_begin();
+    if (kind == KIND_INT) {
+        long long x;
+        while (read_ll(&x)) {
+            res.checksum += (unsigned long long)x;
+            res.tokens++;
+        }
+    } else if (kind == KIND_FLOAT) {
+        double x;
+        while (read_double(&x)) {
+            res.checksum += double_bits(x);
+            res.tokens++;
+        }
+    } else {
+        while (read_str(str_buf)) {
+            res.checksum += strlen(str_buf) * 31 + (unsigned char)str_buf[0];
+            res.tokens++;
+        }
     }
-    
-    fclose(fp);
+    res.ns = now_ns() - start;
+    res.ok = 1;
+    return res;
 }
 
-/* Benchmark original version */
-static double benchmark_original(const char *filename) {
-    FILE *fp = fopen(filename, "r");
-    if (!fp) {
-        perror("Failed to open test data");
-        exit(1);
+/* Copies path into fd from a separate process */
+static pid_t start_feeder(const char *path, int fd) {
+    pid_t pid = fork();
+    if (pid) return pid;
+    static char buf[1 << 16];
+    int in = open(path, O_RDONLY);
+    ssize_t n;
+    while (in >= 0 && (n = read(in, buf, sizeof(buf))) > 0) {
+        char *p = buf;
+        while (n > 0) {
+            ssize_t k = write(fd, p, n);
+            if (k < 0) {
+                if (errno == EINTR) continue;
+                _exit(1);
+            }
+            p += k;
+            n -= k;
+        }
     }
-    
-    /* Redirect stdin */
-    stdin = fp;
-    
-    double start = get_time();
-    
-    /* Reset buffer state */
-    extern char ybuf[], *yptr, *yend;
-    yptr = ybuf;
-    yend = ybuf;
-    
-    int sum = 0;
-    double sum_d = 0;
-    char str[100];
-    
-    /* Parse data */
-    for (int i = 0; i < BENCHMARK_SIZE; i++) {
-        int a;
-        double b;
-        if (yscanf("%d %lf %s", &a, &b, str) != 3) break;
-        sum += a;
-        sum_d += b;
+    _exit(0);
+}
+
+/* One timed run in a fresh child process */
+static struct bench_result run_once(const char *path, int kind, int use_pipe) {
+    struct bench_result res;
+    int rp[2];
+    memset(&res, 0, sizeof(res));
+    if (pipe(rp)) return res;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(rp[0]);
+        if (use_pipe) {
+            int ip[2];
+            if (pipe(ip)) _exit(1);
+            pid_t feeder = start_feeder(path, ip[1]);
+            close(ip[1]);
+            dup2(ip[0], 0);
+            close(ip[0]);
+            res = parse_stdin(kind);
+            waitpid(feeder, NULL, 0);
+        } else {
+            int fd = open(path, O_RDONLY);
+            if (fd < 0) _exit(1);
+            dup2(fd, 0);
+            close(fd);
+            res = parse_stdin(kind);
+        }
+        if (write(rp[1], &res, sizeof(res)) != (ssize_t)sizeof(res)) _exit(1);
+        _exit(0);
     }
-    
-    double end = get_time();
-    fclose(fp);
-    
-    printf("Original version: sum=%d, sum_d=%.2f\n", sum, sum_d);
-    return end - start;
+
+    close(rp[1]);
+    if (pid > 0) {
+        if (read(rp[0], &res, sizeof(res)) != (ssize_t)sizeof(res)) res.ok = 0;
+        waitpid(pid, NULL, 0);
+    }
+    close(rp[0]);
+    return res;
+}
+
+static int cmp_ll(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+/* ============================================================================
+ * CORPORA
+ * ============================================================================ */
+
+static unsigned long long rng_state = 0x9e3779b97f4a7c15ULL;
+
+static unsigned long long rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
 }
 
-/* Benchmark optimized version */
-static double benchmark_optimized(const char *filename) {
-    FILE *fp = fopen(filename, "r");
+static FILE *open_corpus(const char *dir, const char *name) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *fp = fopen(path, "wb");
     if (!fp) {
-        perror("Failed to open test data");
+        perror(path);
         exit(1);
     }
-    
-    /* Redirect stdin */
-    stdin = fp;
-    
-    double start = get_time();
-    
-    int sum = 0;
-    double sum_d = 0;
-    char str[100];
-    
-    /* Parse data */
-    for (int i = 0; i < BENCHMARK_SIZE; i++) {
-        int a;
-        double b;
-        if (yscanf("%d %lf %s", &a, &b, str) != 3) break;
-        sum += a;
-        sum_d += b;
+    return fp;
+}
+
+/* Writes the standard corpora into dir; scale multiplies every size */
+static void generate(const char *dir, int scale) {
+    long n = 2000000L * scale;
+    FILE *fp;
+
+    fp = open_corpus(dir, "ints_short.txt");
+    for (long i = 0; i < n; i++)
+        fprintf(fp, "%d%c", (int)(rng() % 2000) - 1000, i % 16 == 15 ? '\n' : ' ');
+    fclose(fp);
+
+    fp = open_corpus(dir, "ints_19digit.txt");
+    for (long i = 0; i < n; i++) {
+        long long v = (long long)(1000000000000000000ULL + rng() % 8000000000000000000ULL);
+        fprintf(fp, "%lld\n", rng() & 1 ? -v : v);
+    }
+    fclose(fp);
+
+    fp = open_corpus(dir, "ints_crlf.txt");
+    for (long i = 0; i < n; i++) fprintf(fp, "%u\r\n", (unsigned)(rng() % 1000000));
+    fclose(fp);
+
+    fp = open_corpus(dir, "floats_exp.txt");
+    for (long i = 0; i < n; i++) {
+        double m = (double)(rng() >> 11) / 9007199254740992.0;
+        int e = (int)(rng() % 60) - 30;
+        if (i & 1)
+            fprintf(fp, "%.17g\n", (rng() & 1 ? -m : m) * 1e10);
+        else
+            fprintf(fp, "%.6fe%d\n", m * 10, e);
+    }
+    fclose(fp);
+
+    fp = open_corpus(dir, "strings_long.txt");
+    for (long i = 0; i < n / 100; i++) {
+        int len = 50 + (int)(rng() % 2000);
+        for (int j = 0; j < len; j++) fputc('a' + (int)(rng() % 26), fp);
+        fputc(i % 4 == 3 ? '\n' : ' ', fp);
     }
-    
-    double end = get_time();
     fclose(fp);
-    
-    printf("Optimized version: sum=%d, sum_d=%.2f\n", sum, sum_d);
-    return end - start;
 }
 
-/* Benchmark specific operations */
-static void benchmark_operations(void) {
-    printf("\n=== Operation-specific benchmarks ===\n");
-    
-    /* Integer parsing benchmark */
-    {
-        FILE *fp = fopen("int_test.txt", "w");
-        for (int i = 0; i < 100000; i++) {
-            fprintf(fp, "%d ", i);
+/* ============================================================================
+ * DRIVER
+ * ============================================================================ */
+
+static int kind_of(const char *path) {
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    if (!strncmp(base, "int", 3)) return KIND_INT;
+    if (!strncmp(base, "float", 5)) return KIND_FLOAT;
+    if (!strncmp(base, "str", 3)) return KIND_STR;
+    return -1;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: bench --gen DIR [--scale N]\n"
+            "       bench [--runs N] [--warmup N] [--pipe] [--json] [--no-header] [--kernel NAME] [--format] CORPUS...\n"
+            "       bench --kernels\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    int runs = 11, warmup = 1, use_pipe = 0, json = 0, header = 1, scale = 1;
+    const char *gen_dir = NULL, *kernel = NULL, *name = BENCH_NAME;
+    int first = 0, list_kernels = 0, format = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--runs") && i + 1 < argc) runs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc) warmup = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--scale") && i + 1 < argc) scale = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--gen") && i + 1 < argc) gen_dir = argv[++i];
+        else if (!strcmp(argv[i], "--pipe")) use_pipe = 1;
+        else if (!strcmp(argv[i], "--json")) json = 1;
+        else if (!strcmp(argv[i], "--no-header")) header = 0;
+        else if (!strcmp(argv[i], "--kernel") && i + 1 < argc) kernel = argv[++i];
+        else if (!strcmp(argv[i], "--kernels")) list_kernels = 1;
+        else if (!strcmp(argv[i], "--format")) format = 1;
+        else if (argv[i][0] == '-') usage();
+        else {
+            first = i;
+            break;
         }
-        fclose(fp);
-        
-        FILE *in = fopen("int_test.txt", "r");
-        stdin = in;
-        
-        double start = get_time();
-        int val, count = 0;
-        while (yscanf("%d", &val) == 1) count++;
-        double end = get_time();
-        
-        printf("Integer parsing: %d values in %.3f seconds (%.0f values/sec)\n", 
-               count, end - start, count / (end - start));
-        fclose(in);
     }
-    
-    /* Float parsing benchmark */
-    {
-        FILE *fp = fopen("float_test.txt", "w");
-        for (int i = 0; i < 100000; i++) {
-            fprintf(fp, "%.6f ", (double)i * 1.234567);
-        }
-        fclose(fp);
-        
-        FILE *in = fopen("float_test.txt", "r");
-        stdin = in;
-        
-        double start = get_time();
-        double val;
-        int count = 0;
-        while (yscanf("%lf", &val) == 1) count++;
-        double end = get_time();
-        
-        printf("Float parsing: %d values in %.3f seconds (%.0f values/sec)\n", 
-               count, end - start, count / (end - start));
-        fclose(in);
+    if (gen_dir) {
+        generate(gen_dir, scale > 0 ? scale : 1);
+        return 0;
+    }
+#ifdef BENCH_KERNELS
+    static char name_buf[64];
+    if (list_kernels) {
+        for (int v = 0; v < YKERN_COUNT; v++)
+            if (ykernel_supported(v)) printf("%s\n", ykernel_name(v));
+        return 0;
     }
-    
-    /* String parsing benchmark */
-    {
-        FILE *fp = fopen("string_test.txt", "w");
-        for (int i = 0; i < 100000; i++) {
-            fprintf(fp, "string%d ", i);
+    if (kernel) {
+        if (!bench_set_kernel(kernel)) {
+            fprintf(stderr, "%s: kernel not built in or not supported by this CPU\n", kernel);
+            return 2;
         }
-        fclose(fp);
-        
-        FILE *in = fopen("string_test.txt", "r");
-        stdin = in;
-        
-        double start = get_time();
-        char val[100];
-        int count = 0;
-        while (yscanf("%s", val) == 1) count++;
-        double end = get_time();
-        
-        printf("String parsing: %d values in %.3f seconds (%.0f values/sec)\n", 
-               count, end - start, count / (end - start));
-        fclose(in);
+        snprintf(name_buf, sizeof(name_buf), "%s/%s", BENCH_NAME, kernel);
+        name = name_buf;
     }
-}
+#else
+    if (kernel || list_kernels) usage();
+#endif
+#ifdef BENCH_FORMAT
+    static char format_buf[80];
+    if (format) {
+        bench_format = 1;
+        snprintf(format_buf, sizeof(format_buf), "%s/format", name);
+        name = format_buf;
+    }
+#else
+    if (format) usage();
+#endif
+    if (!first || runs < 1 || runs > BENCH_MAX_RUNS) usage();
 
-/* Memory usage benchmark */
-static void benchmark_memory_usage(void) {
-    printf("\n=== Memory usage analysis ===\n");
-    
-    printf("Original buffer size: %d bytes (%.1f MB)\n", 
-           1 << 22, (1 << 22) / (1024.0 * 1024.0));
-    printf("Optimized buffer size: %d bytes (%.1f MB)\n", 
-           YSCANF_BUFFER_SIZE, YSCANF_BUFFER_SIZE / (1024.0 * 1024.0));
-    
-    printf("Static memory usage (original): ~4 MB\n");
-    printf("Static memory usage (optimized): ~%.1f MB\n", 
-           YSCANF_BUFFER_SIZE / (1024.0 * 1024.0));
-}
+    if (header && !json)
+        printf("parser,corpus,input,bytes,tokens,runs,median_ns,p99_ns,min_ns,mb_per_s,ns_per_token,checksum\n");
 
-/* Cache performance test */
-static void benchmark_cache_performance(void) {
-    printf("\n=== Cache performance test ===\n");
-    
-    /* Test with different input sizes */
-    int sizes[] = {1000, 10000, 100000, 1000000};
-    const char *size_names[] = {"1K", "10K", "100K", "1M"};
-    
-    for (int s = 0; s < 4; s++) {
-        char filename[100];
-        snprintf(filename, sizeof(filename), "cache_test_%s.txt", size_names[s]);
-        
-        /* Generate test data */
-        FILE *fp = fopen(filename, "w");
-        for (int i = 0; i < sizes[s]; i++) {
-            fprintf(fp, "%d %.3f ", i, (double)i);
+    for (int i = first; i < argc; i++) {
+        const char *path = argv[i];
+        int kind = kind_of(path);
+        struct stat st;
+        if (kind < 0 || stat(path, &st)) {
+            fprintf(stderr, "%s: unknown corpus kind or unreadable\n", path);
+            return 1;
         }
-        fclose(fp);
-        
-        /* Benchmark */
-        FILE *in = fopen(filename, "r");
-        stdin = in;
-        
-        double start = get_time();
-        int ival;
-        double fval;
-        int count = 0;
-        while (yscanf("%d %lf", &ival, &fval) == 2) count++;
-        double end = get_time();
-        
-        printf("Size %s: %d pairs in %.3f seconds (%.1f ns/pair)\n", 
-               size_names[s], count, end - start, 
-               ((end - start) * 1e9) / count);
-        
-        fclose(in);
-        remove(filename);
-    }
-}
 
-int main(void) {
-    printf("=== YScanF Performance Benchmark ===\n\n");
-    
-    /* Generate test data */
-    printf("Generating test data...\n");
-    generate_test_data("benchmark_data.txt", BENCHMARK_SIZE);
-    
-    printf("Test data: %d records generated\n", BENCHMARK_SIZE);
-    
-    /* Run main benchmark */
-    printf("\n=== Main benchmark (averaged over %d iterations) ===\n", ITERATIONS);
-    
-    double total_orig = 0, total_opt = 0;
-    
-    for (int i = 0; i < ITERATIONS; i++) {
-        printf("\nIteration %d:\n", i + 1);
-        
-        double t_orig = benchmark_original("benchmark_data.txt");
-        double t_opt = benchmark_optimized("benchmark_data.txt");
-        
-        total_orig += t_orig;
-        total_opt += t_opt;
-        
-        printf("Original: %.3f seconds\n", t_orig);
-        printf("Optimized: %.3f seconds\n", t_opt);
-        printf("Speedup: %.2fx\n", t_orig / t_opt);
+        long long t[BENCH_MAX_RUNS];
+        struct bench_result res;
+        memset(&res, 0, sizeof(res));
+        for (int w = 0; w < warmup; w++) run_once(path, kind, use_pipe);
+        for (int r = 0; r < runs; r++) {
+            res = run_once(path, kind, use_pipe);
+            if (!res.ok) {
+                fprintf(stderr, "%s: run failed\n", path);
+                return 1;
+            }
+            t[r] = res.ns;
+        }
+        qsort(t, runs, sizeof(t[0]), cmp_ll);
+
+        long long median = runs % 2 ? t[runs / 2] : (t[runs / 2 - 1] + t[runs / 2]) / 2;
+        long long p99 = t[(runs * 99 + 99) / 100 - 1];
+        double mbps = median ? (double)st.st_size / median * 1e3 : 0;
+        double ns_tok = res.tokens ? (double)median / res.tokens : 0;
+        const char *base = strrchr(path, '/');
+        base = base ? base + 1 : path;
+
+        if (json)
+            printf("{\"parser\":\"%s\",\"corpus\":\"%s\",\"input\":\"%s\",\"bytes\":%lld,"
+                   "\"tokens\":%llu,\"runs\":%d,\"median_ns\":%lld,\"p99_ns\":%lld,\"min_ns\":%lld,"
+                   "\"mb_per_s\":%.2f,\"ns_per_token\":%.3f,\"checksum\":\"%016llx\"}\n",
+                   name, base, use_pipe ? "pipe" : "file", (long long)st.st_size, res.tokens, runs,
+                   median, p99, t[0], mbps, ns_tok, res.checksum);
+        else
+            printf("%s,%s,%s,%lld,%llu,%d,%lld,%lld,%lld,%.2f,%.3f,%016llx\n", name, base,
+                   use_pipe ? "pipe" : "file", (long long)st.st_size, res.tokens, runs, median, p99,
+                   t[0], mbps, ns_tok, res.checksum);
+        fflush(stdout);
     }
-    
-    double avg_orig = total_orig / ITERATIONS;
-    double avg_opt = total_opt / ITERATIONS;
-    
-    printf("\n=== Average Results ===\n");
-    printf("Original average: %.3f seconds\n", avg_orig);
-    printf("Optimized average: %.3f seconds\n", avg_opt);
-    printf("Average speedup: %.2fx\n", avg_orig / avg_opt);
-    printf("Performance improvement: %.1f%%\n", 
-           ((avg_orig - avg_opt) / avg_orig) * 100);
-    
-    /* Run specialized benchmarks */
-    benchmark_operations();
-    benchmark_memory_usage();
-    benchmark_cache_performance();
-    
-    /* Cleanup */
-    remove("benchmark_data.txt");
-    remove("int_test.txt");
-    remove("float_test.txt");
-    remove("string_test.txt");
-    
-    printf("\n=== Benchmark Complete ===\n");
-    
+
     return 0;
 }
@@ -68,7 +68,7 @@ check_requirements() {
 format_files() {
     echo -e "${YELLOW}Formatting C/C++ files...${NC}"
     
-    local files=("yscanf.h" "yscanf_optimized.h" "test_yscanf.c" "benchmark.c")
+    local files=("yscanf.h" "test_yscanf.c" "test_yscanf.cpp" "benchmark.c" "fuzz_yscanf.c")
     
     for file in "${files[@]}"; do
         if [ -f "$file" ]; then
@@ -92,7 +92,7 @@ run_static_analysis() {
              --inline-suppr --force \
              --std=c11 \
              --platform=unix64 \
-             yscanf_optimized.h test_yscanf.c \
+             yscanf.h test_yscanf.c \
              2>&1 | tee cppcheck_report.txt
     
     if [ $? -eq 0 ]; then
@@ -147,28 +147,131 @@ generate_docs() {
     echo -e "${YELLOW}Generating documentation...${NC}"
     
     # Create simple documentation from header comments
-    if [ -f "yscanf_optimized.h" ]; then
+    if [ -f "yscanf.h" ]; then
         echo "Extracting function documentation..."
-        grep -E "^/\*\*|^ \* @|^static inline" yscanf_optimized.h > function_docs.txt
+        grep -E "^/\*\*|^ \* @|^static inline" yscanf.h > function_docs.txt
         echo -e "${GREEN}Function documentation extracted to function_docs.txt${NC}"
     fi
 }
 
 # Performance benchmarking
+# BENCH_RUNS, BENCH_SCALE and CC/CXX can be overridden from the environment
 run_benchmarks() {
     echo -e "${YELLOW}Running performance benchmarks...${NC}"
-    
-    if [ -f "benchmark.c" ]; then
-        echo "Compiling benchmark..."
-        gcc -O3 -march=native -flto benchmark.c -o benchmark -lm
-        
-        echo "Running benchmark..."
-        ./benchmark > benchmark_results.txt
-        
-        echo -e "${GREEN}Benchmark results saved to benchmark_results.txt${NC}"
-    else
+
+    if [ ! -f "benchmark.c" ]; then
         echo -e "${YELLOW}No benchmark.c found, skipping benchmarks${NC}"
+        return
+    fi
+
+    local dir="bench_build"
+    local cc="${CC:-gcc}" cxx="${CXX:-g++}"
+    local flags="-O3 -march=native"
+    local runs="${BENCH_RUNS:-11}"
+    mkdir -p "$dir/corpus"
+
+    echo "Compiling benchmark variants..."
+    local bins=()
+    for v in yscanf yscanf_fail yscanf_unchecked scanf strto; do
+        local def
+        def=$(echo "$v" | tr '[:lower:]' '[:upper:]')
+        $cc $flags -DBENCH_$def benchmark.c -o "$dir/bench_$v" -lm && bins+=("$dir/bench_$v")
+    done
+    for v in cin from_chars; do
+        local def
+        def=$(echo "$v" | tr '[:lower:]' '[:upper:]')
+        $cxx $flags -std=c++17 -x c++ -DBENCH_$def benchmark.c -o "$dir/bench_$v" && bins+=("$dir/bench_$v")
+    done
+
+    # one portable binary with every scan kernel, run once per variant the CPU has
+    local dispatch="$dir/bench_yscanf_dispatch"
+    $cc -O3 -DYSCANF_DISPATCH -DBENCH_YSCANF benchmark.c -o "$dispatch" -lm || dispatch=""
+
+    echo "Generating corpora..."
+    "${bins[0]}" --gen "$dir/corpus" --scale "${BENCH_SCALE:-1}"
+
+    echo "Running benchmark..."
+    local header=""
+    : > benchmark_results.csv
+    for bin in "${bins[@]}"; do
+        for mode in "" "--pipe"; do
+            "$bin" --runs "$runs" $mode $header "$dir"/corpus/*.txt >> benchmark_results.csv
+            header="--no-header"
+        done
+    done
+    if [ -n "$dispatch" ]; then
+        for kernel in $("$dispatch" --kernels); do
+            "$dispatch" --runs "$runs" --kernel "$kernel" $header "$dir"/corpus/*.txt >> benchmark_results.csv
+            header="--no-header"
+        done
+    fi
+
+    echo -e "${GREEN}Benchmark results saved to benchmark_results.csv${NC}"
+}
+
+# Fuzz and differential run: sanitizer build of fuzz_yscanf.c over generated inputs
+# FUZZ_RUNS and FUZZ_SEED can be overridden from the environment
+run_fuzz() {
+    echo -e "${YELLOW}Running fuzz and differential checks...${NC}"
+
+    local dir="fuzz_build"
+    local cc="${CC:-gcc}"
+    mkdir -p "$dir"
+
+    $cc -O1 -g -fsanitize=address,undefined -fno-sanitize-recover=undefined -DYSCANF_DISPATCH \
+        fuzz_yscanf.c -o "$dir/fuzz_yscanf" -lm
+    (cd "$dir" && ./fuzz_yscanf --random "${FUZZ_RUNS:-20000}" --seed "${FUZZ_SEED:-1}")
+
+    # libFuzzer target when the compiler has one; it is built but not run
+    if command_exists clang && echo 'int main(void){return 0;}' |
+        clang -fsanitize=fuzzer -x c - -o /dev/null 2>/dev/null; then
+        clang -O1 -g -fsanitize=fuzzer,address,undefined -DFUZZ_LIBFUZZER \
+            fuzz_yscanf.c -o "$dir/fuzz_yscanf_libfuzzer" -lm
+        echo "libFuzzer target: $dir/fuzz_yscanf_libfuzzer"
+    fi
+
+    echo -e "${GREEN}Fuzz checks passed${NC}"
+}
+
+# Throughput gate: fails if yscanf got slower than the saved baseline
+# BENCH_BASELINE (default bench_baseline.csv) is written on the first run;
+# BENCH_TOLERANCE is the allowed slowdown in percent (default 10)
+run_gate() {
+    echo -e "${YELLOW}Running throughput regression gate...${NC}"
+
+    local dir="bench_build"
+    local cc="${CC:-gcc}"
+    local baseline="${BENCH_BASELINE:-bench_baseline.csv}"
+    mkdir -p "$dir/corpus"
+
+    $cc -O3 -march=native -DBENCH_YSCANF benchmark.c -o "$dir/bench_yscanf" -lm
+    "$dir/bench_yscanf" --gen "$dir/corpus" --scale "${BENCH_SCALE:-1}"
+    "$dir/bench_yscanf" --runs "${BENCH_RUNS:-11}" "$dir"/corpus/*.txt > "$dir/gate.csv"
+    "$dir/bench_yscanf" --runs "${BENCH_RUNS:-11}" --pipe --no-header "$dir"/corpus/*.txt >> "$dir/gate.csv"
+
+    if [ ! -f "$baseline" ]; then
+        cp "$dir/gate.csv" "$baseline"
+        echo -e "${GREEN}No baseline yet: saved this run to $baseline${NC}"
+        return
     fi
+
+    # columns: parser,corpus,input,...,mb_per_s ($10),...,checksum ($12)
+    if ! awk -F, -v tol="${BENCH_TOLERANCE:-10}" '
+        FNR == 1 { next }
+        NR == FNR { mbps[$2 "," $3] = $10; sum[$2 "," $3] = $12; next }
+        ($2 "," $3) in mbps {
+            k = $2 "," $3
+            if ($12 != sum[k]) { printf "%s: checksum %s, baseline %s\n", k, $12, sum[k]; bad = 1 }
+            if ($10 < mbps[k] * (1 - tol / 100)) {
+                printf "%s: %.2f MB/s, baseline %.2f MB/s\n", k, $10, mbps[k]; bad = 1
+            }
+        }
+        END { exit bad }' "$baseline" "$dir/gate.csv"; then
+        echo -e "${RED}Throughput gate failed (tolerance ${BENCH_TOLERANCE:-10}%)${NC}"
+        exit 1
+    fi
+
+    echo -e "${GREEN}Throughput gate passed${NC}"
 }
 
 # Clean up temporary files
@@ -177,14 +280,18 @@ cleanup() {
     
     rm -f test_input.txt perf_test.txt
     rm -f cppcheck_report.txt function_docs.txt
-    rm -f benchmark benchmark_results.txt
+    rm -rf bench_build benchmark_results.csv fuzz_build
     
     echo -e "${GREEN}Cleanup completed${NC}"
 }
 
 # Main execution
 main() {
-    check_requirements
+    # the benchmark, fuzz and gate runs only need a compiler
+    case "${1:-all}" in
+        benchmark|fuzz|gate|clean) ;;
+        *) check_requirements ;;
+    esac
     
     case "${1:-all}" in
         format)
@@ -202,18 +309,25 @@ main() {
         benchmark)
             run_benchmarks
             ;;
+        fuzz)
+            run_fuzz
+            ;;
+        gate)
+            run_gate
+            ;;
         all)
             format_files
             check_style
             run_static_analysis
             generate_docs
+            run_fuzz
             run_benchmarks
             ;;
         clean)
             cleanup
             ;;
         *)
-            echo "Usage: $0 [format|analyze|style|docs|benchmark|all|clean]"
+            echo "Usage: $0 [format|analyze|style|docs|benchmark|fuzz|gate|all|clean]"
             echo ""
             echo "Commands:"
             echo "  format    - Format all C/C++ files"
@@ -221,6 +335,8 @@ main() {
             echo "  style     - Check code style"
             echo "  docs      - Generate documentation"
             echo "  benchmark - Run performance benchmarks"
+            echo "  fuzz      - Run the fuzz and differential checks"
+            echo "  gate      - Fail if throughput fell below the saved baseline"
             echo "  all       - Run all checks (default)"
             echo "  clean     - Clean temporary files"
             exit 1
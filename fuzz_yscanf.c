@@ -0,0 +1,667 @@
+/**
+ * @file fuzz_yscanf.c
+ * @brief Fuzz target and differential checker for yscanf.h
+ *
+ * Every input is read three ways in lockstep: from a memory span, from a
+ * callback source with an owned (padded) buffer and from a callback source
+ * with a borrowed (unpadded) one. The callbacks hand out 1-16 bytes per
+ * call into buffers of a few dozen bytes, so nearly every token straddles
+ * a refill. The three readers must agree on every result. A second pass
+ * over the same bytes checks the memory reader against libc: strtol,
+ * strtoll, strtoull and strtod for the number readers and sscanf for %s,
+ * %Ns, %[...], %c and whole yscanf() formats. The operation sequence is
+ * derived from the input, so a crash file replays exactly. The raw bytes
+ * also become the key gaps of a few sorted streams merged by ymerge on
+ * the same tiny buffers. Built with -DYSCANF_DISPATCH, each input also
+ * runs on one of the scan kernel variants this CPU supports.
+ *
+ *   clang -O1 -g -fsanitize=fuzzer,address,undefined -DFUZZ_LIBFUZZER fuzz_yscanf.c -o fuzz -lm
+ *   afl-clang-fast -O1 fuzz_yscanf.c -o fuzz -lm
+ *   cc -O1 -g -fsanitize=address,undefined fuzz_yscanf.c -o fuzz -lm
+ *
+ * Usage (without FUZZ_LIBFUZZER):
+ *   fuzz FILE...                  replay inputs, e.g. a crash or a corpus
+ *   fuzz --random N [--seed S]    run N generated number-heavy inputs
+ *   fuzz < FILE                   one input from stdin (AFL)
+ *
+ * A mismatch prints the step and the operation, then aborts.
+ * `./format_code.sh fuzz` builds the sanitizer variant and runs --random.
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+/* small default buffers so readers without an explicit size refill often too */
+#define YSCANF_BUFFER_SIZE 64
+
+#include "yscanf.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FUZZ_MAX_INPUT (1 << 16)
+
+enum {
+    OP_INT,
+    OP_UINT,
+    OP_LL,
+    OP_ULL,
+    OP_LL_FAIL,
+    OP_DOUBLE,
+    OP_STR,
+    OP_STRN,
+    OP_SET,
+    OP_VIEW,
+    OP_LINE,
+    OP_CHAR,
+    OP_ARRAY,
+    OP_MARK,
+    OP_SCANF,
+    OP_COUNT
+};
+
+static const char *const op_names[OP_COUNT] = {"int",  "uint", "ll",   "ull",  "ll_fail",
+                                               "double", "str", "strn", "set",  "view",
+                                               "line", "char", "array", "mark", "scanf"};
+
+/* yscanf() formats whose semantics match libc's (no literals, no %d/%u wrap) */
+static const char *const formats[] = {"%lld %lf", "%s %lld", "%lf%c",   "%3s%lld",
+                                      "%[0-9a-f]%s", "%c %c", "%lf %lf %lf", "%5[^ \n]%lld"};
+#define FORMAT_COUNT (sizeof(formats) / sizeof(formats[0]))
+
+/* The result of one operation; s holds string results and the scanf %s/%c items */
+struct result {
+    int ok;
+    long long i[4];
+    unsigned long long u;
+    double d[4];
+    size_t len;
+    char *s, *s2;
+};
+
+struct chunk_src {
+    const char *p;
+    size_t left, step;
+};
+
+static size_t chunk_read(void *ctx, char *buf, size_t cap) {
+    struct chunk_src *c = (struct chunk_src *)ctx;
+    size_t n = c->left < c->step ? c->left : c->step;
+    if (n > cap) n = cap;
+    memcpy(buf, c->p, n);
+    c->p += n;
+    c->left -= n;
+    return n;
+}
+
+static const char *cur_op;
+static size_t cur_step;
+static const uint8_t *cur_data;
+static size_t cur_size;
+static const char *dump_path; /* where --random saves a failing input */
+
+static void mismatch(const char *what) {
+    FILE *fp;
+    fprintf(stderr, "fuzz_yscanf: step %zu, op %s: %s\n", cur_step, cur_op, what);
+    if (dump_path && (fp = fopen(dump_path, "wb"))) {
+        fwrite(cur_data, 1, cur_size, fp);
+        fclose(fp);
+        fprintf(stderr, "fuzz_yscanf: input saved to %s\n", dump_path);
+    }
+    abort();
+}
+
+static int same_double(double a, double b) {
+    if (isnan(a) || isnan(b)) return isnan(a) && isnan(b);
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+/* a tiny xorshift, so the operation sequence depends only on the input */
+static unsigned next_rand(unsigned long long *s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return (unsigned)(*s >> 32);
+}
+
+/* ============================================================================
+ * OPERATIONS
+ * ============================================================================ */
+
+static void run_op(yreader *r, int op, unsigned arg, struct result *res) {
+    static yset set;
+    static int set_ready;
+    ystr v;
+    char c, c2;
+    int n;
+
+    if (!set_ready) {
+        yset_compile(&set, "[a-z0-9]");
+        set_ready = 1;
+    }
+    res->ok = 0;
+    res->len = 0;
+    switch (op) {
+        case OP_INT: {
+            int x = 0;
+            res->ok = yread_int_ovf_r(r, &x, YOVF_SATURATE);
+            res->i[0] = x;
+            break;
+        }
+        case OP_UINT: {
+            unsigned x = 0;
+            res->ok = yread_uint_ovf_r(r, &x, YOVF_SATURATE);
+            res->u = x;
+            break;
+        }
+        case OP_LL:
+            res->i[0] = 0;
+            res->ok = yread_ll_ovf_r(r, &res->i[0], YOVF_SATURATE);
+            break;
+        case OP_ULL:
+            res->u = 0;
+            res->ok = yread_ull_ovf_r(r, &res->u, YOVF_SATURATE);
+            break;
+        case OP_LL_FAIL:
+            res->i[0] = 0;
+            res->ok = yread_ll_ovf_r(r, &res->i[0], YOVF_FAIL);
+            break;
+        case OP_DOUBLE:
+            res->d[0] = 0;
+            res->ok = yread_double_ok_r(r, &res->d[0]);
+            break;
+        case OP_STR:
+            if ((res->ok = yread_str_ok_r(r, res->s))) res->len = strlen(res->s);
+            break;
+        case OP_STRN:
+            if ((res->ok = yread_strn_ok_r(r, res->s, 1 + arg % 8))) res->len = strlen(res->s);
+            break;
+        case OP_SET:
+            if ((res->ok = yread_set_ok_r(r, &set, res->s, 1 + arg % 12))) res->len = strlen(res->s);
+            break;
+        case OP_VIEW:
+            /* the view dies with the next refill: copy it out now */
+            if ((res->ok = yread_view_ok_r(r, &v))) {
+                memcpy(res->s, v.ptr, v.len);
+                res->len = v.len;
+            }
+            break;
+        case OP_LINE:
+            if ((res->ok = yread_line_ok_r(r, res->s, 2 + (int)(arg % 40)))) res->len = strlen(res->s);
+            break;
+        case OP_CHAR:
+            res->ok = yscanf_r(r, "%c", &c);
+            res->i[0] = c;
+            break;
+        case OP_ARRAY:
+            memset(res->i, 0, sizeof(res->i));
+            res->ok = (int)yread_ll_array_r(r, res->i, 1 + arg % 4);
+            break;
+        case OP_MARK:
+            /* a rewound read must see exactly what the first one saw */
+            yreader_mark(r);
+            res->i[0] = res->i[1] = 0;
+            n = yread_ll_ovf_r(r, &res->i[0], YOVF_SATURATE);
+            if (!yreader_rewind(r)) mismatch("rewind lost the mark");
+            res->ok = yread_ll_ovf_r(r, &res->i[1], YOVF_SATURATE);
+            yreader_unmark(r);
+            if (n != res->ok || res->i[0] != res->i[1]) mismatch("rewound read differs");
+            break;
+        case OP_SCANF: {
+            const char *f = formats[arg % FORMAT_COUNT];
+            memset(res->i, 0, sizeof(res->i));
+            memset(res->d, 0, sizeof(res->d));
+            res->s[0] = res->s2[0] = 0;
+            c = c2 = 0;
+            switch (arg % FORMAT_COUNT) {
+                case 0: res->ok = yscanf_r(r, f, &res->i[0], &res->d[0]); break;
+                case 1: res->ok = yscanf_r(r, f, res->s, &res->i[0]); break;
+                case 2: res->ok = yscanf_r(r, f, &res->d[0], &c); break;
+                case 3: res->ok = yscanf_r(r, f, res->s, &res->i[0]); break;
+                case 4: res->ok = yscanf_r(r, f, res->s, res->s2); break;
+                case 5: res->ok = yscanf_r(r, f, &c, &c2); break;
+                case 6: res->ok = yscanf_r(r, f, &res->d[0], &res->d[1], &res->d[2]); break;
+                default: res->ok = yscanf_r(r, f, res->s, &res->i[0]); break;
+            }
+            res->i[2] = c;
+            res->i[3] = c2;
+            break;
+        }
+    }
+}
+
+static void compare(int op, const struct result *a, const struct result *b) {
+    if (a->ok != b->ok) mismatch("readers disagree on success");
+    if (a->ok <= 0 && op != OP_SCANF) return;
+    switch (op) {
+        case OP_INT:
+        case OP_LL:
+        case OP_LL_FAIL:
+        case OP_CHAR:
+            if (a->i[0] != b->i[0]) mismatch("readers disagree on the value");
+            break;
+        case OP_UINT:
+        case OP_ULL:
+            if (a->u != b->u) mismatch("readers disagree on the value");
+            break;
+        case OP_DOUBLE:
+            if (!same_double(a->d[0], b->d[0])) mismatch("readers disagree on the value");
+            break;
+        case OP_ARRAY:
+            if (memcmp(a->i, b->i, sizeof(a->i))) mismatch("readers disagree on the values");
+            break;
+        case OP_MARK:
+            if (a->i[1] != b->i[1]) mismatch("readers disagree on the value");
+            break;
+        case OP_SCANF:
+            if (memcmp(a->i, b->i, sizeof(a->i)) || strcmp(a->s, b->s) || strcmp(a->s2, b->s2))
+                mismatch("readers disagree on the items");
+            for (int k = 0; k < 3; k++)
+                if (!same_double(a->d[k], b->d[k])) mismatch("readers disagree on the items");
+            break;
+        default:
+            if (a->len != b->len || memcmp(a->s, b->s, a->len)) mismatch("readers disagree on the text");
+            break;
+    }
+}
+
+/* ============================================================================
+ * LIBC ORACLE
+ *
+ * p is the memory reader's position before the operation and the text is
+ * NUL-terminated with no NUL inside, so libc sees exactly what it sees.
+ * ============================================================================ */
+
+static const char *skip_ws(const char *p) {
+    while (yisspace((unsigned char)*p)) p++;
+    return p;
+}
+
+static void check_end(const yreader *r, const char *end) {
+    if (r->ptr != end) mismatch("consumed a different number of bytes than libc");
+}
+
+/*
+ * Where glibc's scanf parses floats unlike strtod: it takes a dangling
+ * exponent ("1e", "1e+") or a cut-off "infinity" ("infin") as part of the
+ * number and drops it, and it stops "nan(...)" after "nan". strtod and
+ * yscanf() do none of these, so %lf formats are not compared against
+ * sscanf when the text has one.
+ */
+static int scanf_float_differs(const char *p) {
+    for (size_t i = 1; p[0] && p[i]; i++) {
+        const char *q = p + i + 1;
+        if (yf_word(p + i - 1, p + i + 2, "inf") && yf_lower((unsigned char)p[i + 2]) == 'i' &&
+            !yf_word(p + i - 1, p + i + 7, "infinity"))
+            return 1;
+        if (p[i] == '(' && i >= 3 && yf_lower((unsigned char)p[i - 1]) == 'n' &&
+            yf_lower((unsigned char)p[i - 2]) == 'a' && yf_lower((unsigned char)p[i - 3]) == 'n')
+            return 1;
+        if ((p[i] != 'e' && p[i] != 'E') || !(yisdigit((unsigned char)p[i - 1]) || p[i - 1] == '.'))
+            continue;
+        if (*q == '+' || *q == '-') q++;
+        if (!yisdigit((unsigned char)*q)) return 1;
+    }
+    return 0;
+}
+
+static void oracle(const yreader *r, const char *p, int op, unsigned arg, const struct result *res,
+                   char *tmp, char *tmp2) {
+    char *e, fmt[16];
+    int n = -1, ret;
+
+    switch (op) {
+        case OP_INT: {
+            long v;
+            errno = 0;
+            v = strtol(p, &e, 10);
+            if (v > INT_MAX) v = INT_MAX;
+            if (v < INT_MIN) v = INT_MIN;
+            if (res->ok != (e != p)) mismatch("strtol disagrees on success");
+            if (res->ok && (res->i[0] != v)) mismatch("strtol disagrees on the value");
+            if (res->ok) check_end(r, e);
+            break;
+        }
+        case OP_UINT:
+        case OP_ULL: {
+            /* yscanf takes no sign for unsigned; strtoull would wrap "-1" */
+            unsigned long long v;
+            const char *q = skip_ws(p);
+            v = strtoull(q, &e, 10);
+            if (*q == '+' || *q == '-') e = (char *)q;
+            if (op == OP_UINT && v > UINT_MAX) v = UINT_MAX;
+            if (res->ok != (e != q)) mismatch("strtoull disagrees on success");
+            if (res->ok && res->u != v) mismatch("strtoull disagrees on the value");
+            if (res->ok) check_end(r, e);
+            break;
+        }
+        case OP_LL:
+        case OP_LL_FAIL: {
+            long long v;
+            int ok;
+            errno = 0;
+            v = strtoll(p, &e, 10);
+            ok = e != p && !(op == OP_LL_FAIL && errno == ERANGE);
+            if (res->ok != ok) mismatch("strtoll disagrees on success");
+            if (res->ok && res->i[0] != v) mismatch("strtoll disagrees on the value");
+            /* a rejected overflow still consumes its digits */
+            if (e != p) check_end(r, e);
+            break;
+        }
+        case OP_DOUBLE: {
+            double v = strtod(p, &e);
+            if (res->ok != (e != p)) mismatch("strtod disagrees on success");
+            if (res->ok && !same_double(res->d[0], v)) mismatch("strtod disagrees on the value");
+            if (res->ok) check_end(r, e);
+            break;
+        }
+        case OP_STR:
+        case OP_VIEW:
+            ret = sscanf(p, "%s%n", tmp, &n);
+            if (res->ok != (ret == 1)) mismatch("sscanf %s disagrees on success");
+            if (res->ok && (res->len != strlen(tmp) || memcmp(res->s, tmp, res->len)))
+                mismatch("sscanf %s disagrees on the token");
+            if (res->ok) check_end(r, p + n);
+            break;
+        case OP_STRN:
+            snprintf(fmt, sizeof(fmt), "%%%us%%n", 1 + arg % 8);
+            ret = sscanf(p, fmt, tmp, &n);
+            if (res->ok != (ret == 1)) mismatch("sscanf %Ns disagrees on success");
+            if (res->ok && strcmp(res->s, tmp)) mismatch("sscanf %Ns disagrees on the token");
+            if (res->ok) check_end(r, p + n);
+            break;
+        case OP_SET:
+            snprintf(fmt, sizeof(fmt), "%%%u[a-z0-9]%%n", 1 + arg % 12);
+            ret = sscanf(p, fmt, tmp, &n);
+            if (res->ok != (ret == 1)) mismatch("sscanf %[...] disagrees on success");
+            if (res->ok && strcmp(res->s, tmp)) mismatch("sscanf %[...] disagrees on the token");
+            if (res->ok) check_end(r, p + n);
+            break;
+        case OP_CHAR: {
+            char c = 0;
+            ret = sscanf(p, "%c", &c);
+            if (res->ok != ret || (ret == 1 && res->i[0] != c)) mismatch("sscanf %c disagrees");
+            break;
+        }
+        case OP_SCANF: {
+            /* yscanf() returns EOF for any failed first item, libc 0 for a matching failure */
+            long long i0 = 0;
+            double d[3] = {0, 0, 0};
+            char c = 0, c2 = 0;
+            tmp[0] = tmp2[0] = 0;
+            if (strstr(formats[arg % FORMAT_COUNT], "%lf") && scanf_float_differs(p)) break;
+            switch (arg % FORMAT_COUNT) {
+                case 0: ret = sscanf(p, formats[0], &i0, &d[0]); break;
+                case 1: ret = sscanf(p, formats[1], tmp, &i0); break;
+                case 2: ret = sscanf(p, formats[2], &d[0], &c); break;
+                case 3: ret = sscanf(p, formats[3], tmp, &i0); break;
+                case 4: ret = sscanf(p, formats[4], tmp, tmp2); break;
+                case 5: ret = sscanf(p, formats[5], &c, &c2); break;
+                case 6: ret = sscanf(p, formats[6], &d[0], &d[1], &d[2]); break;
+                default: ret = sscanf(p, formats[7], tmp, &i0); break;
+            }
+            if (ret <= 0 ? res->ok > 0 : res->ok != ret) mismatch("sscanf disagrees on the count");
+            if (ret <= 0) break;
+            if (res->i[0] != i0 || res->i[2] != c || res->i[3] != c2 || strcmp(res->s, tmp) ||
+                strcmp(res->s2, tmp2))
+                mismatch("sscanf disagrees on the items");
+            for (int k = 0; k < 3; k++)
+                if (!same_double(res->d[k], d[k])) mismatch("sscanf disagrees on the items");
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/* ============================================================================
+ * DRIVER
+ * ============================================================================ */
+
+#define FUZZ_READERS 3
+
+/*
+ * Runs the input-derived operation sequence over [in,in+n) on all readers.
+ * in[n] must be 0; with oracle set, in holds no other NUL.
+ */
+static void run_script(const char *in, size_t n, unsigned long long seed, int oracle_on) {
+    yreader r[FUZZ_READERS];
+    struct chunk_src src[2];
+    struct result res[FUZZ_READERS];
+    char user_buf[48], *tmp, *tmp2;
+    size_t max_steps = 2 * n + 16;
+    int i;
+
+    for (i = 0; i < FUZZ_READERS; i++) {
+        res[i].s = (char *)malloc(n + 1);
+        res[i].s2 = (char *)malloc(n + 1);
+    }
+    /* sanitizers count a %12[...] as 13 bytes written whatever it matched */
+    tmp = (char *)malloc(n + 16);
+    tmp2 = (char *)malloc(n + 16);
+
+    yreader_init_mem(&r[0], in, n);
+    for (i = 0; i < 2; i++) {
+        src[i].p = in;
+        src[i].left = n;
+        src[i].step = 1 + next_rand(&seed) % 16;
+        yreader_init_fn(&r[i + 1], chunk_read, &src[i]);
+    }
+    yreader_set_alloc(&r[1], YBUF_MALLOC, 1 + next_rand(&seed) % 32);
+    yreader_set_buffer(&r[2], user_buf, 8 + next_rand(&seed) % (sizeof(user_buf) - 8));
+
+    for (cur_step = 0; cur_step < max_steps; cur_step++) {
+        int op = (int)(next_rand(&seed) % OP_COUNT);
+        unsigned arg = next_rand(&seed);
+        const char *p = r[0].ptr;
+        int c[FUZZ_READERS];
+
+        cur_op = op_names[op];
+        if (op == OP_SCANF) cur_op = formats[arg % FORMAT_COUNT];
+        for (i = 0; i < FUZZ_READERS; i++) run_op(&r[i], op, arg, &res[i]);
+        for (i = 1; i < FUZZ_READERS; i++) compare(op, &res[0], &res[i]);
+        if (oracle_on) oracle(&r[0], p, op, arg, &res[0], tmp, tmp2);
+
+        /* step over whatever stopped a failed read, so every input ends */
+        for (i = 0; i < FUZZ_READERS; i++) c[i] = res[0].ok > 0 ? ypeek_r(&r[i]) : yget_r(&r[i]);
+        if (c[1] != c[0] || c[2] != c[0]) mismatch("readers are at different bytes");
+        if (c[0] == EOF) break;
+    }
+
+    for (i = 0; i < FUZZ_READERS; i++) {
+        yreader_close(&r[i]);
+        free(res[i].s);
+        free(res[i].s2);
+    }
+    free(tmp);
+    free(tmp2);
+}
+
+#define MERGE_STREAMS 5
+
+/*
+ * Deals the input bytes round-robin to up to MERGE_STREAMS sorted key
+ * streams (each byte the gap to the previous key), each with a tag after
+ * every key, and merges them through chunked callback readers on pooled
+ * buffers. The merge must return every key once, in order, with its tag.
+ */
+static void run_merge(const uint8_t *data, size_t size, unsigned long long seed) {
+    yreader r[MERGE_STREAMS];
+    struct chunk_src src[MERGE_STREAMS];
+    char *text[MERGE_STREAMS];
+    size_t len[MERGE_STREAMS], count[MERGE_STREAMS], seen[MERGE_STREAMS] = {0};
+    int k = 1 + (int)(next_rand(&seed) % MERGE_STREAMS), i;
+    long long prev = LLONG_MIN;
+    size_t total = 0;
+    ymerge m;
+    ykey key;
+
+    cur_op = "merge";
+    cur_step = 0;
+    for (i = 0; i < k; i++) {
+        long long v = -1000;
+        /* keys stay under 8 digits for FUZZ_MAX_INPUT bytes, so a record fits in 24 */
+        text[i] = (char *)malloc((size / (size_t)k + 1) * 24 + 1);
+        len[i] = count[i] = 0;
+        for (size_t j = (size_t)i; j < size; j += (size_t)k) {
+            v += data[j];
+            len[i] += (size_t)sprintf(text[i] + len[i], "%lld t%zu\n", v, count[i]++);
+        }
+        src[i].p = text[i];
+        src[i].left = len[i];
+        src[i].step = 1 + next_rand(&seed) % 16;
+        yreader_init_fn(&r[i], chunk_read, &src[i]);
+        total += count[i];
+    }
+
+    if (!ymerge_init(&m, r, k, YKEY_LL, 0)) mismatch("merge setup failed");
+    while ((i = ymerge_next(&m, &key)) >= 0) {
+        char tag[32], want[32];
+        if (key.ll < prev) mismatch("merge output out of order");
+        if (!yread_strn_ok_r(&r[i], tag, sizeof(tag) - 1)) mismatch("merge lost the tag after a key");
+        snprintf(want, sizeof(want), "t%zu", seen[i]++);
+        if (strcmp(tag, want)) mismatch("merge tag came from the wrong record");
+        prev = key.ll;
+        cur_step++;
+    }
+    if (cur_step != total) mismatch("merge lost keys");
+    ymerge_free(&m);
+    for (i = 0; i < k; i++) {
+        yreader_close(&r[i]);
+        free(text[i]);
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    unsigned long long seed = 0x9e3779b97f4a7c15ULL;
+    char *in;
+
+    if (size > FUZZ_MAX_INPUT) return 0;
+    cur_data = data;
+    cur_size = size;
+    for (size_t i = 0; i < size; i++) seed = (seed ^ data[i]) * 0x100000001b3ULL;
+    seed |= 1;
+    in = (char *)malloc(size + 1);
+    memcpy(in, data, size);
+    in[size] = 0;
+
+    /* with YSCANF_DISPATCH each input also picks a scan kernel variant */
+    if (!ykernel_select((int)(seed % YKERN_COUNT))) ykernel_select(YKERN_BEST);
+
+    /* raw bytes: the readers must agree with each other, NULs included */
+    run_script(in, size, seed, 0);
+    run_merge(data, size, seed);
+
+    /*
+     * libc stops at a NUL; hex floats are only parsed with YSCANF_HEXFLOAT,
+     * so without it an 'x' is remapped too
+     */
+    for (size_t i = 0; i < size; i++) {
+        if (!in[i]) in[i] = '\1';
+#ifndef YSCANF_HEXFLOAT
+        if (in[i] == 'x' || in[i] == 'X') in[i] = 'y';
+#endif
+    }
+    run_script(in, size, seed, 1);
+
+    free(in);
+    return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+
+/* number-heavy inputs: digit runs around the 9/18/19/20 boundaries, signs, exponents, words */
+static size_t generate(unsigned long long *s, char *out, size_t cap) {
+    static const char *const words[] = {"inf", "-infinity", "nan", "nan(0x1f)", "NaN(", "1e",
+                                        "1e+", ".5", "5.", "-.e1", "+", "-", "0x1p-3", "e5",
+                                        "9223372036854775808", "-9223372036854775809",
+                                        "18446744073709551616", "2147483648", "4294967296",
+                                        "1.7976931348623157e308", "4.9e-324", "2.4703282292062328e-324"};
+    static const char seps[] = " \t\n\r\v\f,;ab";
+    size_t n = 0, len = next_rand(s) % (cap / 2);
+
+    while (n + 64 < cap && n < len) {
+        unsigned k = next_rand(s) % 8;
+        if (k < 3) {
+            const char *w = words[next_rand(s) % (sizeof(words) / sizeof(words[0]))];
+            size_t l = strlen(w);
+            memcpy(out + n, w, l);
+            n += l;
+        } else if (k < 6) {
+            unsigned d = 1 + next_rand(s) % 24;
+            if (next_rand(s) & 1) out[n++] = "+-"[next_rand(s) & 1];
+            while (d--) out[n++] = (char)('0' + next_rand(s) % 10);
+            if (k == 5) {
+                out[n++] = '.';
+                for (d = next_rand(s) % 20; d; d--) out[n++] = (char)('0' + next_rand(s) % 10);
+                if (next_rand(s) & 1) n += (size_t)sprintf(out + n, "e%d", (int)(next_rand(s) % 700) - 350);
+            }
+        } else {
+            out[n++] = (char)(next_rand(s) & 0xff);
+        }
+        for (unsigned w = next_rand(s) % 3; w; w--) out[n++] = seps[next_rand(s) % (sizeof(seps) - 1)];
+    }
+    return n;
+}
+
+static int run_file(FILE *fp, const char *name) {
+    static uint8_t buf[FUZZ_MAX_INPUT];
+    size_t n = fread(buf, 1, sizeof(buf), fp);
+    if (ferror(fp)) {
+        fprintf(stderr, "%s: read error\n", name);
+        return 1;
+    }
+    LLVMFuzzerTestOneInput(buf, n);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    static char buf[1 << 12];
+    unsigned long long seed = 1, s;
+    long runs = -1;
+    int i, first = 0;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--random") && i + 1 < argc) runs = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc) seed = strtoull(argv[++i], NULL, 0);
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: fuzz [FILE...] | fuzz --random N [--seed S] | fuzz < FILE\n");
+            return 2;
+        } else {
+            first = i;
+            break;
+        }
+    }
+    if (runs >= 0) {
+        dump_path = "fuzz_failure.bin";
+        s = seed * 0x9e3779b97f4a7c15ULL | 1;
+        for (long k = 0; k < runs; k++) {
+            size_t n = generate(&s, buf, sizeof(buf));
+            LLVMFuzzerTestOneInput((const uint8_t *)buf, n);
+        }
+        printf("fuzz_yscanf: %ld random inputs passed (seed %llu)\n", runs, seed);
+        return 0;
+    }
+    if (!first) return run_file(stdin, "stdin");
+    for (i = first; i < argc; i++) {
+        FILE *fp = fopen(argv[i], "rb");
+        if (!fp) {
+            perror(argv[i]);
+            return 1;
+        }
+        if (run_file(fp, argv[i])) return 1;
+        fclose(fp);
+    }
+    printf("fuzz_yscanf: %d inputs passed\n", argc - first);
+    return 0;
+}
+
+#endif /* FUZZ_LIBFUZZER */
@@ -6,12 +6,17 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <string.h>
+#include <time.h>
 #include <assert.h>
 #include <limits.h>
 #include <float.h>
+#include <errno.h>
 
 #include "yscanf.h"
+#include "yprintf.h"
 
 /* Test result tracking */
 static int tests_run = 0;
@@ -31,10 +36,11 @@ static int tests_passed = 0;
         tests_passed++; \
     } while(0)
 
+/* ends the current test; the summary counts it as failed */
 #define FAIL(msg) \
     do { \
         printf("FAILED: %s\n", msg); \
-        exit(1); \
+        return; \
     } while(0)
 
 /* Helper function to create test input */
@@ -47,8 +53,9 @@ static void create_test_input(const char *input) {
     fprintf(fp, "%s", input);
     fclose(fp);
     
-    /* Redirect stdin to test file */
+    /* Redirect stdin to test file; the default reader must start over */
     freopen("test_input.txt", "r", stdin);
+    yscanf_reset();
 }
 
 /* Test basic integer reading */
@@ -141,6 +148,32 @@ void test_floating_point(void) {
     PASS();
 }
 
+/* Test that floats are correctly rounded (bit-identical to strtod) */
+void test_float_rounding(void) {
+    TEST("float rounding");
+
+    static const char *cases[] = {
+        "0.1", "2.2250738585072011e-308", "4.9406564584124654e-324",
+        "1.7976931348623157e308", "9007199254740993", "123456789012345678901234567890",
+        "0.30000000000000004", "1e-400", "1e400", "7.2057594037927933e16",
+        "2.4703282292062328e-324", "1.00000000000000011102230246251565404236316680908203125"
+    };
+    char input[512] = "";
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        strcat(input, cases[i]);
+        strcat(input, " ");
+    }
+    create_test_input(input);
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        double got, want = strtod(cases[i], NULL);
+        if (yscanf("%f", &got) != 1) FAIL("Failed to read float");
+        if (memcmp(&got, &want, sizeof(got)) != 0) FAIL(cases[i]);
+    }
+
+    PASS();
+}
+
 /* Test string reading */
 void test_string_reading(void) {
     TEST("string reading");
@@ -164,20 +197,117 @@ void test_character_reading(void) {
     
     create_test_input("ABC 123");
     
-    char a, b, c, d, e, f, g;
+    char a, b, c, d, e, f;
     int ret = yscanf("%c%c%c %c%c%c", &a, &b, &c, &d, &e, &f);
     
     if (ret != 6) FAIL("Failed to read 6 characters");
     if (a != 'A') FAIL("First character mismatch");
     if (b != 'B') FAIL("Second character mismatch");
     if (c != 'C') FAIL("Third character mismatch");
-    if (d != ' ') FAIL("Fourth character mismatch");
-    if (e != '1') FAIL("Fifth character mismatch");
-    if (f != '2') FAIL("Sixth character mismatch");
+    if (d != '1') FAIL("Fourth character mismatch");
+    if (e != '2') FAIL("Fifth character mismatch");
+    if (f != '3') FAIL("Sixth character mismatch");
     
     PASS();
 }
 
+/* Test %Ns widths and %[...] scansets */
+void test_bounded_strings(void) {
+    TEST("bounded strings");
+
+    const char *in = "abcdefghij xy key_1=some value,rest]]^";
+    yreader r;
+    yreader_init_mem(&r, in, strlen(in));
+    char a[8], b[16], c[32];
+    if (yscanf_r(&r, "%4s%s", a, b) != 2) FAIL("Failed to read width-limited strings");
+    if (strcmp(a, "abcd") != 0 || strcmp(b, "efghij") != 0) FAIL("Width split mismatch");
+    if (!yread_strn_ok_r(&r, a, 1) || strcmp(a, "x") != 0) FAIL("Single-byte width mismatch");
+    if (!yread_str_ok_r(&r, a) || strcmp(a, "y") != 0) FAIL("Token remainder lost");
+    if (yscanf_r(&r, " %[a-z0-9_]", c) != 1 || strcmp(c, "key_1") != 0) FAIL("Range scanset mismatch");
+    if (yscanf_r(&r, "%[a-z]", c) != EOF) FAIL("Empty scanset match accepted");
+    yget_r(&r);
+    if (yscanf_r(&r, "%7[^,]", c) != 1 || strcmp(c, "some va") != 0) FAIL("Width on negated scanset mismatch");
+    if (yscanf_r(&r, "%[^,]", c) != 1 || strcmp(c, "lue") != 0) FAIL("Negated scanset mismatch");
+    yget_r(&r);
+    if (yscanf_r(&r, "%[^]]%[]]%[x^]", c, a, b) != 3) FAIL("Bracket scansets failed");
+    if (strcmp(c, "rest") != 0 || strcmp(a, "]]") != 0 || strcmp(b, "^") != 0) FAIL("Bracket scanset mismatch");
+    if (yscanf_r(&r, "%[abc", c) != -1) FAIL("Unterminated scanset accepted");
+    yreader_close(&r);
+
+    /* the block kernel agrees with the bitmap on every byte value */
+    yset set;
+    unsigned char data[512];
+    unsigned seed = 12345;
+    for (int k = 0; k < 64; k++) {
+        char spec[64] = "[";
+        int n = 1;
+        if (k & 1) spec[n++] = '^';
+        for (int m = 0; m < 5; m++) {
+            seed = seed * 1103515245u + 12345u;
+            spec[n++] = (char)(1 + (seed >> 16) % 255);
+            if (spec[n - 1] == ']' || spec[n - 1] == '^' || spec[n - 1] == '-') spec[n - 1] = 'a';
+        }
+        spec[n++] = ']';
+        if (!yset_compile(&set, spec)) FAIL("Generated scanset rejected");
+        for (size_t i = 0; i < sizeof(data); i++) {
+            seed = seed * 1103515245u + 12345u;
+            data[i] = (unsigned char)(seed >> 16);
+            if (!yset_has(&set, data[i]) && (seed >> 8 & 3)) data[i] = (unsigned char)spec[n - 2];
+        }
+        for (size_t i = 0; i < 64; i++) {
+            char *p = (char *)data + i, *e = (char *)data + sizeof(data), *q = p;
+            while (q < e && yset_has(&set, *q)) q++;
+            if (yset_span(&set, p, e) != q) FAIL("Scanset kernel disagrees with the bitmap");
+        }
+    }
+
+    /* stop runs for the SSE2 kernel; a set with more than YSET_STOPS uses the byte loop */
+    yset_compile(&set, "[^,]");
+    if (set.nstop != 1 || set.stop[0] != ',' || set.slen[0] != 0) FAIL("Negated set stop run wrong");
+    yset_compile(&set, "[a-z0-9_]");
+    if (set.nstop != 4 || set.stop[0] != 0 || set.slen[0] != '0' - 1 || set.stop[3] != 'z' + 1 || set.slen[3] != 255 - 'z' - 1)
+        FAIL("Word set stop runs wrong");
+    yset_compile(&set, "[acegi]");
+    if (set.nstop != 0) FAIL("Set with too many stop runs not marked");
+
+    /* a format rewritten in place must not reuse the cached set */
+    char fmt[8];
+    yreader_init_mem(&r, "aabb", 4);
+    strcpy(fmt, "%[a]");
+    if (yscanf_r(&r, fmt, c) != 1 || strcmp(c, "aa") != 0) FAIL("First cached set mismatch");
+    strcpy(fmt, "%[b]");
+    if (yscanf_r(&r, fmt, c) != 1 || strcmp(c, "bb") != 0) FAIL("Stale cached scanset used");
+    yreader_close(&r);
+
+    /* long fields straddling refills of a small buffer */
+    FILE *fp = tmpfile();
+    if (!fp) FAIL("Failed to create scanset test file");
+    for (int i = 0; i < 2000; i++) fprintf(fp, "field_%d_abcdefghijklmnopqrstuvwxyz,%d\n", i, i);
+    rewind(fp);
+    yreader_init_file(&r, fp);
+    yreader_set_alloc(&r, YBUF_MALLOC, 64);
+    for (int i = 0; i < 2000; i++) {
+        char want[64], got[64];
+        int v;
+        sprintf(want, "field_%d_abcdefghijklmnopqrstuvwxyz", i);
+        if (yscanf_r(&r, " %63[^,]", got) != 1 || strcmp(got, want) != 0) {
+            yreader_close(&r);
+            fclose(fp);
+            FAIL("Scanset field from file mismatch");
+        }
+        yget_r(&r);
+        if (!yread_int_ok_r(&r, &v) || v != i) {
+            yreader_close(&r);
+            fclose(fp);
+            FAIL("Value after scanset field mismatch");
+        }
+    }
+    yreader_close(&r);
+    fclose(fp);
+
+    PASS();
+}
+
 /* Test whitespace handling */
 void test_whitespace_handling(void) {
     TEST("whitespace handling");
@@ -197,6 +327,31 @@ void test_whitespace_handling(void) {
     PASS();
 }
 
+/* Test the locale-independent character classes */
+void test_char_classes(void) {
+    TEST("character classes");
+
+    for (int c = 0; c < 256; c++) {
+        int space = c == ' ' || (c >= '\t' && c <= '\r');
+        if (!yisspace(c) != !space) FAIL("Whitespace class mismatch");
+        if (!yisblank(c) != !(space && c != '\n')) FAIL("Blank class mismatch");
+        if (!yisdigit(c) != !(c >= '0' && c <= '9')) FAIL("Digit class mismatch");
+    }
+    if (yisdigit(EOF)) FAIL("EOF classified as a digit");
+
+    /* \v and \f separate tokens; a non-ASCII byte such as 0xA0 does not */
+    const char *in = "1\v2\f3 \xa0x\xa0";
+    yreader r;
+    int a, b, c;
+    char s[8];
+    yreader_init_mem(&r, in, strlen(in));
+    if (yscanf_r(&r, "%d%d%d%s", &a, &b, &c, s) != 4) FAIL("Failed to read around \\v and \\f");
+    if (a != 1 || b != 2 || c != 3 || strcmp(s, "\xa0x\xa0") != 0) FAIL("Class-separated tokens mismatch");
+    yreader_close(&r);
+
+    PASS();
+}
+
 /* Test overflow handling */
 void test_overflow_handling(void) {
     TEST("overflow handling");
@@ -214,6 +369,102 @@ void test_overflow_handling(void) {
     PASS();
 }
 
+/* Test the per-call overflow policies */
+void test_overflow_policies(void) {
+    TEST("overflow policies");
+
+    const char *in = "99999999999999999999 -3000000000 4294967296 7";
+    int pols[] = {YOVF_SATURATE, YOVF_FAIL, YOVF_UNCHECKED};
+    for (int i = 0; i < 3; i++) {
+        yreader r;
+        yreader_init_mem(&r, in, strlen(in));
+        long long a = 0;
+        int b = 0, d = 0;
+        unsigned c = 0;
+        int oka = yread_ll_ovf_r(&r, &a, pols[i]);
+        int okb = yread_int_ovf_r(&r, &b, pols[i]);
+        int okc = yread_uint_ovf_r(&r, &c, pols[i]);
+        if (!yread_int_ovf_r(&r, &d, pols[i]) || d != 7) FAIL("Reader lost its place after an overflow");
+        yreader_close(&r);
+
+        if (pols[i] == YOVF_SATURATE) {
+            if (!oka || a != LLONG_MAX) FAIL("64-bit overflow did not saturate");
+            if (!okb || b != INT_MIN) FAIL("int overflow did not saturate");
+            if (!okc || c != UINT_MAX) FAIL("unsigned overflow did not saturate");
+        } else if (pols[i] == YOVF_FAIL) {
+            if (oka || okb || okc) FAIL("Overflow did not fail the conversion");
+        } else {
+            if (!oka || a != 7766279631452241919LL) FAIL("Unchecked 64-bit value did not wrap");
+            if (!okb || b != 1294967296) FAIL("Unchecked int did not wrap");
+            if (!okc || c != 0) FAIL("Unchecked unsigned did not wrap");
+        }
+    }
+
+    PASS();
+}
+
+/* Test exact range checks against strtoll/strtoull at every digit count */
+void test_integer_bounds(void) {
+    TEST("integer bounds");
+
+    static const char *edge[] = {
+        "2147483647", "2147483648", "-2147483648", "-2147483649", "4294967295", "4294967296",
+        "9223372036854775807", "9223372036854775808", "-9223372036854775808",
+        "-9223372036854775809", "18446744073709551615", "18446744073709551616",
+        "18446744073709551619", "99999999999999999999", "184467440737095516150",
+        "00000000000000000000000000042", "-0000000000002147483648", "0000000004294967295",
+    };
+    char buf[64];
+    unsigned seed = 12345;
+    for (int i = 0; i < 20000; i++) {
+        const char *s = buf;
+        if (i < (int)(sizeof(edge) / sizeof(edge[0]))) {
+            s = edge[i];
+        } else {
+            int n = 1 + i % 24, k = 0;
+            seed = seed * 1103515245u + 12345u;
+            if (seed >> 30 == 1) buf[k++] = '-';
+            for (int j = 0; j < n; j++) {
+                seed = seed * 1103515245u + 12345u;
+                buf[k++] = (char)('0' + (seed >> 16) % 10);
+            }
+            buf[k] = 0;
+        }
+
+        errno = 0;
+        long long want = strtoll(s, NULL, 10);
+        int range = errno == ERANGE;
+        int want32 = want > INT_MAX ? INT_MAX : want < INT_MIN ? INT_MIN : (int)want;
+        int range32 = range || want != want32;
+        long long got = 0;
+        int got32 = 0, ok;
+        yreader r;
+
+        yreader_init_mem(&r, s, strlen(s));
+        if (!yread_ll_ovf_r(&r, &got, YOVF_SATURATE) || got != want) FAIL("64-bit saturation differs from strtoll");
+        yreader_init_mem(&r, s, strlen(s));
+        if (yread_ll_ovf_r(&r, &got, YOVF_FAIL) == range) FAIL("64-bit overflow detection differs from strtoll");
+        yreader_init_mem(&r, s, strlen(s));
+        if (!yread_int_ovf_r(&r, &got32, YOVF_SATURATE) || got32 != want32) FAIL("int saturation is not exact");
+        yreader_init_mem(&r, s, strlen(s));
+        if (yread_int_ovf_r(&r, &got32, YOVF_FAIL) == range32) FAIL("int overflow detection is not exact");
+
+        if (*s == '-') continue;
+        errno = 0;
+        unsigned long long uwant = strtoull(s, NULL, 10);
+        range = errno == ERANGE;
+        unsigned long long ugot = 0;
+        unsigned u32 = 0;
+        yreader_init_mem(&r, s, strlen(s));
+        if (!yread_ull_ovf_r(&r, &ugot, YOVF_SATURATE) || ugot != uwant) FAIL("unsigned 64-bit saturation differs from strtoull");
+        yreader_init_mem(&r, s, strlen(s));
+        ok = yread_uint_ovf_r(&r, &u32, YOVF_FAIL);
+        if (ok != (!range && uwant <= UINT_MAX) || (ok && u32 != uwant)) FAIL("unsigned overflow detection is not exact");
+    }
+
+    PASS();
+}
+
 /* Test EOF handling */
 void test_eof_handling(void) {
     TEST("EOF handling");
@@ -250,6 +501,998 @@ void test_mixed_types(void) {
     PASS();
 }
 
+/* Test independent reader contexts */
+void test_reader_context(void) {
+    TEST("reader context");
+
+    const char *in1 = "1 2 3";
+    const char *in2 = "10 abc 20";
+    yreader r1, r2;
+    yreader_init_mem(&r1, in1, strlen(in1));
+    yreader_init_mem(&r2, in2, strlen(in2));
+
+    int a, b, c, d;
+    char s[16];
+    if (yscanf_r(&r1, "%d", &a) != 1 || a != 1) FAIL("First reader mismatch");
+    if (yscanf_r(&r2, "%d %s", &b, s) != 2 || b != 10) FAIL("Second reader mismatch");
+    if (strcmp(s, "abc") != 0) FAIL("Second reader string mismatch");
+    if (yscanf_r(&r1, "%d %d", &c, &d) != 2 || c != 2 || d != 3) FAIL("Readers interfered");
+    if (yscanf_r(&r1, "%d", &a) != EOF) FAIL("Exhausted reader did not report EOF");
+    if (yscanf_r(&r2, "%d", &b) != 1 || b != 20) FAIL("Second reader lost its position");
+
+    yreader_close(&r1);
+    yreader_close(&r2);
+
+    PASS();
+}
+
+/* Test a callback source that hands out input in small chunks */
+struct chunk_src {
+    const char *p;
+    size_t left, step;
+    int calls;
+};
+
+static size_t chunk_read(void *ctx, char *buf, size_t cap) {
+    struct chunk_src *c = (struct chunk_src *)ctx;
+    size_t n = c->left < c->step ? c->left : c->step;
+    if (n > cap) n = cap;
+    memcpy(buf, c->p, n);
+    c->p += n;
+    c->left -= n;
+    c->calls++;
+    return n;
+}
+
+void test_callback_source(void) {
+    TEST("callback source");
+
+    const char *in = "12345 -678 hello 3.25 9223372036854775807\nlast line\n";
+    struct chunk_src c = {in, strlen(in), 3, 0};
+    yreader r;
+    yreader_init_fn(&r, chunk_read, &c);
+
+    int a, b;
+    char s[16];
+    double d;
+    long long e;
+    char line[32];
+    if (yscanf_r(&r, "%d %d %s %lf %lld", &a, &b, s, &d, &e) != 5) FAIL("Failed to read from a callback");
+    if (a != 12345 || b != -678 || strcmp(s, "hello") != 0 || d != 3.25 || e != LLONG_MAX)
+        FAIL("Tokens split across callback reads were misparsed");
+    if (!yread_line_ok_r(&r, line, sizeof line) || strcmp(line, "last line") != 0)
+        FAIL("Line split across callback reads was misparsed");
+    if (yscanf_r(&r, "%d", &a) != EOF) FAIL("Callback source did not report EOF");
+    if (c.calls < 10) FAIL("Callback was not used for refills");
+    yreader_close(&r);
+
+    PASS();
+}
+
+/* Test floats whose end is only known after a refill */
+void test_float_refill_edges(void) {
+    TEST("float refill edges");
+
+    const char *in = "-infinity 1e+x inf nan(abc 2.5\n";
+    for (size_t step = 1; step <= 12; step++) {
+        struct chunk_src c = {in, strlen(in), step, 0};
+        yreader r;
+        double d[5];
+        char s[2][8];
+        yreader_init_fn(&r, chunk_read, &c);
+        if (yscanf_r(&r, "%lf %lf%s %lf %lf%s %lf", &d[0], &d[1], s[0], &d[2], &d[3], s[1], &d[4]) != 7)
+            FAIL("Float tokens split across callback reads were misparsed");
+        if (!isinf(d[0]) || d[0] > 0 || d[1] != 1.0 || !isinf(d[2]) || !isnan(d[3]) || d[4] != 2.5)
+            FAIL("Float values split across callback reads are wrong");
+        /* what strtod leaves of a token stays unread, whatever the chunking */
+        if (strcmp(s[0], "e+x") != 0 || strcmp(s[1], "(abc") != 0)
+            FAIL("Float parse consumed bytes past the number");
+        yreader_close(&r);
+    }
+
+    PASS();
+}
+
+/* Test magic-byte detection and gzip decoding */
+#ifdef YSCANF_ZLIB
+/* one gzip member of s appended to fp */
+static void gzip_append(FILE *fp, const char *s) {
+    unsigned char out[1 << 16];
+    z_stream zs;
+    memset(&zs, 0, sizeof zs);
+    deflateInit2(&zs, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    zs.next_in = (Bytef *)s;
+    zs.avail_in = (uInt)strlen(s);
+    zs.next_out = out;
+    zs.avail_out = sizeof out;
+    deflate(&zs, Z_FINISH);
+    fwrite(out, 1, sizeof out - zs.avail_out, fp);
+    deflateEnd(&zs);
+}
+#endif
+
+void test_decompress_source(void) {
+    TEST("decompress source");
+
+    /* plain seekable input is put back and still read (and mapped) as usual */
+    FILE *fp = tmpfile();
+    if (!fp) FAIL("Failed to create decompression test file");
+    fputs("17 25 33", fp);
+    rewind(fp);
+    yreader r;
+    int a, b, c;
+    yreader_init_file(&r, fp);
+    if (yreader_decompress(&r) != YZ_NONE) FAIL("Plain file was taken for compressed input");
+    if (yscanf_r(&r, "%d %d %d", &a, &b, &c) != 3 || a != 17 || b != 25 || c != 33)
+        FAIL("Plain file was not rewound after sniffing");
+    yreader_close(&r);
+    fclose(fp);
+
+    /* plain input that cannot seek replays the sniffed bytes */
+    const char *in = "4 5";
+    struct chunk_src cs = {in, strlen(in), 1, 0};
+    yreader_init_fn(&r, chunk_read, &cs);
+    if (yreader_decompress(&r) != YZ_NONE) FAIL("Plain callback was taken for compressed input");
+    if (yscanf_r(&r, "%d %d", &a, &b) != 2 || a != 4 || b != 5) FAIL("Sniffed bytes were not replayed");
+    yreader_close(&r);
+
+#ifdef YSCANF_ZLIB
+    /* two concatenated members, read through a small buffer */
+    fp = tmpfile();
+    if (!fp) FAIL("Failed to create gzip test file");
+    char *text = (char *)malloc(20000 * 8);
+    size_t len = 0;
+    for (int i = 0; i < 10000; i++) len += (size_t)sprintf(text + len, "%d\n", i * 7);
+    gzip_append(fp, text);
+    gzip_append(fp, "-1 end\n");
+    rewind(fp);
+    yreader_init_file(&r, fp);
+    yreader_set_alloc(&r, YBUF_MALLOC, 100);
+    if (yreader_decompress(&r) != YZ_GZIP) FAIL("gzip magic was not detected");
+    for (int i = 0; i < 10000; i++)
+        if (!yread_int_ok_r(&r, &a) || a != i * 7) FAIL("gzip stream was misdecoded");
+    char s[8];
+    if (yscanf_r(&r, "%d %s", &a, s) != 2 || a != -1 || strcmp(s, "end") != 0)
+        FAIL("Second gzip member was not read");
+    if (yscanf_r(&r, "%d", &a) != EOF) FAIL("gzip source did not report EOF");
+    yreader_close(&r);
+    fclose(fp);
+    free(text);
+#endif
+
+    PASS();
+}
+
+/* Test digit runs cut at every position by refills, padded and not */
+void test_padded_buffers(void) {
+    TEST("padded buffers");
+
+    char text[8192];
+    unsigned long long want[400];
+    size_t len = 0;
+    unsigned seed = 99;
+    for (int i = 0; i < 400; i++) {
+        int n = 1 + i % 20;
+        char *tok = text + len;
+        for (int j = 0; j < n; j++) {
+            seed = seed * 1103515245u + 12345u;
+            text[len++] = (char)('1' + (seed >> 16) % 9);
+        }
+        text[len] = 0;
+        want[i] = strtoull(tok, NULL, 10);
+        text[len++] = i % 3 ? ' ' : '\n';
+    }
+
+    char user[24];
+    for (int step = 1; step <= 17; step++) {
+        for (int borrowed = 0; borrowed < 2; borrowed++) {
+            struct chunk_src c = {text, len, (size_t)step, 0};
+            yreader r;
+            yreader_init_fn(&r, chunk_read, &c);
+            if (borrowed) yreader_set_buffer(&r, user, sizeof user);
+            else yreader_set_alloc(&r, YBUF_MALLOC, 32);
+            for (int i = 0; i < 400; i++) {
+                unsigned long long x;
+                if (!yread_ull_ok_r(&r, &x) || x != want[i]) FAIL("Digit run split by a refill was misparsed");
+                if (!borrowed && i < 300 && !r.pad) FAIL("Owned buffer lost its sentinel");
+            }
+            if (borrowed && r.pad && r.buf == user) FAIL("Borrowed buffer was treated as padded");
+            yreader_close(&r);
+        }
+    }
+
+    PASS();
+}
+
+/* Test atomic sign handling and mark/rewind across refills */
+void test_mark_rewind(void) {
+    TEST("mark and rewind");
+
+    for (int step = 1; step <= 5; step += 4) {
+        const char *in = "-x +7 - 12 +";
+        struct chunk_src c = {in, strlen(in), (size_t)step, 0};
+        yreader r;
+        int a;
+        yreader_init_fn(&r, chunk_read, &c);
+        yreader_set_alloc(&r, YBUF_MALLOC, 4);
+        if (yread_int_ok_r(&r, &a) || yget_r(&r) != '-') FAIL("Failed int consumed its sign");
+        if (yget_r(&r) != 'x') FAIL("Failed int consumed input");
+        if (!yread_int_ok_r(&r, &a) || a != 7) FAIL("Signed int misparsed");
+        if (yread_int_ok_r(&r, &a) || yget_r(&r) != '-') FAIL("Lone sign was consumed");
+        if (!yread_int_ok_r(&r, &a) || a != 12) FAIL("Int after a lone sign misparsed");
+        if (yread_int_ok_r(&r, &a) || yget_r(&r) != '+') FAIL("Sign at EOF was consumed");
+        yreader_close(&r);
+    }
+
+    /* try an int, else take the token as a string; tokens outgrow the buffer */
+    const char *in = "12 apple 345 banana_split_with_a_long_name -6 -cherry 7";
+    struct chunk_src c = {in, strlen(in), 3, 0};
+    yreader r;
+    yreader_init_fn(&r, chunk_read, &c);
+    yreader_set_alloc(&r, YBUF_MALLOC, 8);
+    const char *want[] = {"#12", "apple", "#345", "banana_split_with_a_long_name", "#-6", "-cherry", "#7"};
+    for (int i = 0; i < 7; i++) {
+        char s[64];
+        int x;
+        yskip_space_r(&r);
+        yreader_mark(&r);
+        if (yread_int_ok_r(&r, &x) && (yisspace(ypeek_r(&r)) || ypeek_r(&r) == EOF)) {
+            sprintf(s, "#%d", x);
+        } else {
+            if (!yreader_rewind(&r)) FAIL("Rewind failed");
+            if (!yread_str_ok_r(&r, s)) FAIL("String after rewind missing");
+        }
+        yreader_unmark(&r);
+        if (strcmp(s, want[i]) != 0) FAIL("Speculative parse mismatch");
+    }
+    char rest[8];
+    if (yread_str_ok_r(&r, rest)) FAIL("Reader did not end after the last token");
+    yreader_close(&r);
+
+    PASS();
+}
+
+/* Test a k-way merge over files and callback streams */
+void test_merge_streams(void) {
+    TEST("merge streams");
+
+    enum { K = 6 };
+    static char text[K][16384];
+    static struct chunk_src cs[K];
+    FILE *fp[K] = {0};
+    yreader r[K];
+    long long total = 0;
+    unsigned seed = 7;
+
+    for (int i = 0; i < K; i++) {
+        size_t len = 0;
+        long long v = -500;
+        int n = i == 2 ? 0 : 200 + i * 150;
+        for (int j = 0; j < n; j++) {
+            seed = seed * 1103515245u + 12345u;
+            v += (seed >> 16) % 5;
+            /* a payload word after every key */
+            len += (size_t)sprintf(text[i] + len, "%lld w%d_%d\n", v, i, j);
+        }
+        total += n;
+        if (i % 2) {
+            cs[i].p = text[i];
+            cs[i].left = len;
+            cs[i].step = 100;
+            yreader_init_fn(&r[i], chunk_read, &cs[i]);
+        } else {
+            fp[i] = tmpfile();
+            if (!fp[i]) FAIL("Failed to create merge test file");
+            fwrite(text[i], 1, len, fp[i]);
+            rewind(fp[i]);
+            yreader_init_file(&r[i], fp[i]);
+        }
+    }
+
+    ymerge m;
+    if (!ymerge_init(&m, r, K, YKEY_LL, 64 << 10)) FAIL("Failed to set up the merge");
+    if (r[1].buf_kind != YBK_POOL || r[1].cap + YSCANF_PAD > (64 << 10) / K) FAIL("Stream buffer was not pooled");
+
+    ykey key;
+    long long prev = LLONG_MIN, count = 0;
+    int prev_i = -1, i;
+    int seen[K] = {0};
+    while ((i = ymerge_next(&m, &key)) >= 0) {
+        char word[32], want[32];
+        if (key.ll < prev || (key.ll == prev && i < prev_i)) FAIL("Merge output out of order");
+        if (!yread_str_ok_r(&r[i], word)) FAIL("Payload after the key missing");
+        sprintf(want, "w%d_%d", i, seen[i]++);
+        if (strcmp(word, want) != 0) FAIL("Payload came from the wrong record");
+        prev = key.ll;
+        prev_i = i;
+        count++;
+    }
+    if (count != total) FAIL("Merge lost keys");
+    ymerge_free(&m);
+    for (i = 0; i < K; i++) {
+        yreader_close(&r[i]);
+        if (fp[i]) fclose(fp[i]);
+    }
+
+    PASS();
+}
+
+#ifdef YSCAN_R
+/* Test the C11 _Generic front end: one reader per argument type */
+void test_generic_scan(void) {
+    TEST("generic scan");
+
+    const char *in = "-5 7 -9000000000 18000000000000000000 0.125 token view";
+    yreader r;
+    int i;
+    unsigned u;
+    long long ll;
+    unsigned long long ull;
+    double d;
+    char s[16];
+    ystr v;
+    yreader_init_mem(&r, in, strlen(in));
+    if (YSCAN_R(&r, &i, &u, &ll, &ull, &d, s, &v) != 7) FAIL("Generic scan read the wrong count");
+    if (i != -5 || u != 7 || ll != -9000000000LL || ull != 18000000000000000000ULL || d != 0.125)
+        FAIL("Generic scan number mismatch");
+    if (strcmp(s, "token") != 0 || v.len != 4 || memcmp(v.ptr, "view", 4) != 0) FAIL("Generic scan text mismatch");
+    if (YSCAN_R(&r, &i) != EOF) FAIL("Generic scan EOF not reported");
+
+    yreader_init_mem(&r, "3 x", 3);
+    if (YSCAN_R(&r, &i, &u, &d) != 1 || i != 3) FAIL("Generic scan mismatch count wrong");
+
+    create_test_input("41 42");
+    if (YSCAN(&i, &u) != 2 || i != 41 || u != 42) FAIL("Generic scan on stdin mismatch");
+
+    PASS();
+}
+#endif
+
+/* Test the compiled-format cache against reused, evicted and uncached formats */
+void test_format_cache(void) {
+    TEST("format cache");
+
+    const char *in = "7 -8 2.5 word 123456789012 x";
+    char fmts[24][64];
+    for (int round = 0; round < 3; round++) {
+        /* more distinct formats than the cache holds, all spelled differently */
+        for (int i = 0; i < 24; i++) {
+            snprintf(fmts[i], sizeof fmts[i], "%%d%*s%%d %%lf %%s %%lld %%c", i + 1, "");
+            yreader r;
+            int a, b;
+            double d;
+            char s[8], c;
+            long long e;
+            yreader_init_mem(&r, in, strlen(in));
+            if (yscanf_r(&r, fmts[i], &a, &b, &d, s, &e, &c) != 6) FAIL("Cached format read the wrong count");
+            if (a != 7 || b != -8 || d != 2.5 || strcmp(s, "word") != 0 || e != 123456789012LL || c != 'x')
+                FAIL("Cached format misparsed");
+        }
+    }
+
+    /* same buffer, new text: must not run the old program */
+    char f[24];
+    int a = 0, b = 0;
+    unsigned u = 0;
+    yreader r;
+    strcpy(f, "%d %d");
+    yreader_init_mem(&r, "1 2", 3);
+    if (yscanf_r(&r, f, &a, &b) != 2 || a != 1 || b != 2) FAIL("First format misparsed");
+    strcpy(f, "%u");
+    yreader_init_mem(&r, "3", 1);
+    if (yscanf_r(&r, f, &u) != 1 || u != 3) FAIL("Rewritten format ran a stale program");
+
+    /* malformed and oversized formats keep their old behaviour */
+    yreader_init_mem(&r, "5 6", 3);
+    if (yscanf_r(&r, "%d %q", &a) != -1 || a != 5) FAIL("Malformed format not rejected");
+    /* a format remembered as uncompilable, then rewritten in place into one that compiles */
+    for (int k = 0; k < 3; k++) {
+        char t1[8], t2[8], t3[8];
+        strcpy(f, "%[0-9]%[a-z]%[A-Z]");
+        yreader_init_mem(&r, "12abCD", 6);
+        if (yscanf_r(&r, f, t1, t2, t3) != 3 || strcmp(t1, "12") || strcmp(t2, "ab") || strcmp(t3, "CD"))
+            FAIL("Uncompiled format misparsed");
+    }
+    strcpy(f, "%d %d");
+    yreader_init_mem(&r, "8 9", 3);
+    if (yscanf_r(&r, f, &a, &b) != 2 || a != 8 || b != 9) FAIL("Rewritten format kept the slow entry");
+    char big[128], s1[8], s2[8];
+    snprintf(big, sizeof big, "%%d%80s%%3s %%[a-c]", "");
+    yreader_init_mem(&r, "9 wordy abcabd", 14);
+    if (yscanf_r(&r, big, &a, s1, s2) != 2 || a != 9 || strcmp(s1, "wor") != 0) FAIL("Uncached format misparsed");
+    yreader_init_mem(&r, "9 wor abcabd", 12);
+    if (yscanf_r(&r, big, &a, s1, s2) != 3 || strcmp(s2, "abcab") != 0) FAIL("Uncached scanset misparsed");
+    yreader_init_mem(&r, "9 wordy abcabd", 14);
+    if (yscanf_r(&r, "%d %3s %*[a-c]", &a, s1, s2) != -1) FAIL("Unsupported width form not rejected");
+    yreader_init_mem(&r, "wordy abcabd", 12);
+    char s3[8];
+    if (yscanf_r(&r, "%3s%s %2[a-c]", s1, s2, s3) != 3 || strcmp(s2, "dy") != 0 || strcmp(s3, "ab") != 0)
+        FAIL("Scanset width misparsed");
+
+    PASS();
+}
+
+/* Test arena strings and interning across refills and arena resets */
+void test_arena_strings(void) {
+    TEST("arena strings");
+
+    static const char *tick[] = {"AAPL", "MSFT", "GOOG", "A", "BRK.B", "a_rather_long_symbol_name_x"};
+    char text[65536];
+    size_t len = 0;
+    for (int i = 0; i < 3000; i++) len += (size_t)sprintf(text + len, "%s %d\n", tick[i % 6], i);
+
+    struct chunk_src c = {text, len, 61, 0};
+    yreader r;
+    yarena arena;
+    yintern syms;
+    ystr first[6], keep[100];
+    memset(first, 0, sizeof first);
+    yreader_init_fn(&r, chunk_read, &c);
+    yreader_set_alloc(&r, YBUF_MALLOC, 16);
+    yarena_init(&arena, 4096);
+    yintern_init(&syms, &arena);
+    for (int i = 0; i < 3000; i++) {
+        ystr s;
+        int id, n;
+        if (!yread_intern_ok_r(&r, &syms, &s, &id)) FAIL("Failed to read an interned string");
+        if (id != i % 6) FAIL("Ids are not dense in first-seen order");
+        if (strcmp(s.ptr, tick[i % 6]) != 0 || s.len != strlen(s.ptr)) FAIL("Interned string mismatch");
+        if (!first[id].ptr) first[id] = s;
+        else if (first[id].ptr != s.ptr) FAIL("Equal strings were not deduplicated");
+        if (!yread_int_ok_r(&r, &n) || n != i) FAIL("Lost place after an interned string");
+    }
+    if (syms.n != 6) FAIL("Symbol count mismatch");
+
+    /* plain arena strings survive refills until the arena is reset */
+    yreader_close(&r);
+    c.p = text;
+    c.left = len;
+    yreader_init_fn(&r, chunk_read, &c);
+    yreader_set_alloc(&r, YBUF_MALLOC, 16);
+    for (int batch = 0; batch < 3; batch++) {
+        yarena_reset(&arena);
+        yintern_clear(&syms);
+        for (int i = 0; i < 100; i++) {
+            int n;
+            if (!yread_astr_ok_r(&r, &arena, &keep[i]) || !yread_int_ok_r(&r, &n)) FAIL("Failed to read an arena string");
+        }
+        for (int i = 0; i < 100; i++)
+            if (strcmp(keep[i].ptr, tick[(batch * 100 + i) % 6]) != 0) FAIL("Arena string overwritten by a refill");
+        if (arena.head->next) FAIL("Reset arena did not reuse its block");
+    }
+    yintern_free(&syms);
+    yarena_free(&arena);
+    yreader_close(&r);
+
+    PASS();
+}
+
+/* Test every scan kernel variant this build and CPU can run against the byte loop */
+void test_kernel_variants(void) {
+    TEST("kernel variants");
+
+    static const char alphabet[] = " \t\n\v\f\r\x1f!09az_,\x80\xff";
+    char buf[256];
+    unsigned long long seed = 12345;
+    int tried = 0;
+    yset word, notcomma;
+    yset_compile(&word, "[a-z0-9_]");
+    yset_compile(&notcomma, "[^,\n]");
+    for (size_t i = 0; i < sizeof buf; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        /* runs of one class so spans cross block boundaries */
+        buf[i] = alphabet[(seed >> 59) % (sizeof alphabet - 1)];
+        if (i && (seed >> 40) % 4) buf[i] = buf[i - 1];
+    }
+
+    for (int v = 0; v < YKERN_COUNT; v++) {
+        if (!ykernel_supported(v)) continue;
+        if (!ykernel_select(v) || ykernel_active() != v) FAIL("Supported kernel variant could not be selected");
+        tried++;
+        for (size_t off = 0; off < 80; off++) {
+            for (size_t len = 0; off + len <= sizeof buf; len += 1 + len / 8) {
+                char *p = buf + off, *e = p + len, *q;
+                for (q = p; q < e && yisspace((unsigned char)*q); q++);
+                if (yskip_ws_span(p, e) != q) FAIL("Whitespace skip differs from the byte loop");
+                for (q = p; q < e && !yisspace((unsigned char)*q); q++);
+                if (yfind_ws_span(p, e) != q) FAIL("Token end differs from the byte loop");
+                for (q = p; q < e && yset_has(&word, *q); q++);
+                if (yset_span(&word, p, e) != q) FAIL("Scanset span differs from the byte loop");
+                for (q = p; q < e && yset_has(&notcomma, *q); q++);
+                if (yset_span(&notcomma, p, e) != q) FAIL("Negated scanset span differs from the byte loop");
+            }
+        }
+
+        const char *in = "   \t 12345678901234567 -42\n  token_with_a_long_name_over_32_bytes,rest\n";
+        yreader r;
+        long long a, b;
+        char s[64], t[64];
+        yreader_init_mem(&r, in, strlen(in));
+        if (yscanf_r(&r, "%lld %lld %[a-z_0-9]", &a, &b, s) != 3 || a != 12345678901234567LL ||
+            b != -42 || strcmp(s, "token_with_a_long_name_over_32_bytes") != 0)
+            FAIL("Tokens misparsed with a forced kernel variant");
+        if (yread_str_ok_r(&r, t) != 1 || strcmp(t, ",rest") != 0) FAIL("String misparsed with a forced kernel variant");
+        yreader_close(&r);
+    }
+    if (!tried) FAIL("No kernel variant was usable");
+    ykernel_select(YKERN_BEST);
+
+    PASS();
+}
+
+/* Test bulk array readers */
+void test_array_readers(void) {
+    TEST("array readers");
+
+    const char *in = "5 1 -2 3 40000000000 7 | 1.5 -2e3 0.25";
+    yreader r;
+    yreader_init_mem(&r, in, strlen(in));
+
+    int n, a[8];
+    long long b[2];
+    double d[8];
+    if (!yread_int_ok_r(&r, &n) || n != 5) FAIL("Count mismatch");
+    if (yread_int_array_r(&r, a, 3) != 3) FAIL("Failed to read int array");
+    if (a[0] != 1 || a[1] != -2 || a[2] != 3) FAIL("Int array mismatch");
+    if (yread_ll_array_r(&r, b, 2) != 2) FAIL("Failed to read long long array");
+    if (b[0] != 40000000000LL || b[1] != 7) FAIL("Long long array mismatch");
+    if (yread_int_array_r(&r, a, 8) != 0) FAIL("Array read past a non-numeric token");
+
+    char sep[4];
+    yread_str_ok_r(&r, sep);
+    if (yread_double_array_r(&r, d, 8) != 3) FAIL("Short double array count mismatch");
+    if (d[0] != 1.5 || d[1] != -2000.0 || d[2] != 0.25) FAIL("Double array mismatch");
+
+    yreader_close(&r);
+
+    PASS();
+}
+
+/* Test line records parsed into structs */
+struct rec_row {
+    int id;
+    double v;
+    char name[16];
+};
+
+void test_line_records(void) {
+    TEST("line records");
+
+    static const size_t offs[] = {offsetof(struct rec_row, id), offsetof(struct rec_row, v),
+                                  offsetof(struct rec_row, name)};
+    yrecord rec;
+    if (!yrecord_init(&rec, "%d %lf %s", offs, sizeof(struct rec_row))) FAIL("Schema rejected");
+    if (yrecord_init(&rec, "%d %q", offs, sizeof(struct rec_row))) FAIL("Bad schema accepted");
+    if (yrecord_init(&rec, "%4d %lf", offs, sizeof(struct rec_row))) FAIL("Width on a number accepted");
+    yrecord_init(&rec, "%d %lf %15s", offs, sizeof(struct rec_row));
+
+    const char *in = "1 2.5 alpha\n2 x beta\n\n3 4.0 gamma extra\n4\n5 -1e3 delta\r\n6 7.5 eps\n"
+                     "7 1 abcdefghijklmnopqrstuvwxyz\n8 2 fifteen_bytes__";
+    struct rec_row rows[8];
+    int status[8];
+    yreader r;
+    yreader_init_mem(&r, in, strlen(in));
+    if (yread_records_r(&r, &rec, rows, 8, status) != 8) FAIL("Record count mismatch");
+    if (status[0] || status[4] || status[5] || status[7]) FAIL("Good line reported as bad");
+    if (status[1] != 2 || status[2] != 4 || status[3] != 2 || status[6] != 3) FAIL("Bad line status mismatch");
+    if (strcmp(rows[7].name, "fifteen_bytes__") != 0) FAIL("Full-width field mismatch");
+    if (rows[0].id != 1 || rows[0].v != 2.5 || strcmp(rows[0].name, "alpha") != 0) FAIL("First record mismatch");
+    if (rows[4].id != 5 || rows[4].v != -1000.0 || strcmp(rows[4].name, "delta") != 0) FAIL("CRLF record mismatch");
+    if (rows[5].id != 6 || strcmp(rows[5].name, "eps") != 0) FAIL("Last record mismatch");
+    yreader_close(&r);
+
+    /* lines straddling refills of a small buffer */
+    FILE *fp = tmpfile();
+    if (!fp) FAIL("Failed to create record test file");
+    for (int i = 0; i < 5000; i++) fprintf(fp, "%d %d.25 name%d\n", i, i, i);
+    rewind(fp);
+    yreader_init_file(&r, fp);
+    yreader_set_alloc(&r, YBUF_MALLOC, 64);
+    long long sum = 0;
+    size_t n = 0, got;
+    while ((got = yread_records_r(&r, &rec, rows, 8, status)) > 0) {
+        for (size_t i = 0; i < got; i++) {
+            char want[16];
+            sprintf(want, "name%d", rows[i].id);
+            if (status[i] || rows[i].v != rows[i].id + 0.25 || strcmp(rows[i].name, want) != 0) {
+                yreader_close(&r);
+                fclose(fp);
+                FAIL("Record from file mismatch");
+            }
+            sum += rows[i].id;
+        }
+        n += got;
+    }
+    yreader_close(&r);
+    fclose(fp);
+    if (n != 5000 || sum != 12497500LL) FAIL("File record count mismatch");
+
+    PASS();
+}
+
+/* Test column (struct-of-arrays) ingestion */
+void test_columns(void) {
+    TEST("columns");
+
+    const char *in = "1 2 3 4 5 6 7";
+    yrecord rec;
+    int c0[8], c1[8];
+    void *cols[] = {c0, c1};
+    yreader r;
+    yrecord_init(&rec, "%d %d", NULL, 0);
+    yreader_init_mem(&r, in, strlen(in));
+    if (yread_columns_r(&r, &rec, cols, 8) != 3) FAIL("Partial row counted");
+    if (c0[0] != 1 || c1[0] != 2 || c0[2] != 5 || c1[2] != 6) FAIL("Homogeneous columns mismatch");
+    yreader_close(&r);
+
+    ystr sv[8];
+    void *scols[] = {c0, sv};
+    yrecord_init(&rec, "%d %S", NULL, 0);
+    yreader_init_mem(&r, "1 a", 3);
+    if (yread_columns_r(&r, &rec, scols, 8) != 0) FAIL("View column accepted without an arena");
+    ycolumns t;
+
+    FILE *fp = tmpfile();
+    if (!fp) FAIL("Failed to create column test file");
+    for (int i = 0; i < 3000; i++) fprintf(fp, "%d %d.5 -%d.25 %d\n", i, i, i, i * 2);
+    rewind(fp);
+
+    yarena arena;
+    yarena_init(&arena, 4096);
+    if (!ycolumns_init(&t, "%d %lf %lf %lld", &arena)) FAIL("Column schema rejected");
+    yreader_init_file(&r, fp);
+    if (ycolumns_read_r(&r, &t, 10) != 10) FAIL("Row limit not honoured");
+    if (ycolumns_read_r(&r, &t, 0) != 2990 || t.rows != 3000) FAIL("Column row count mismatch");
+    yreader_close(&r);
+    fclose(fp);
+
+    int *ids = (int *)t.col[0];
+    double *hi = (double *)t.col[1], *lo = (double *)t.col[2];
+    long long *dbl = (long long *)t.col[3];
+    for (int i = 0; i < 3000; i++) {
+        if (ids[i] != i || hi[i] != i + 0.5 || lo[i] != -(i + 0.25) || dbl[i] != 2LL * i) {
+            yarena_free(&arena);
+            FAIL("Column value mismatch");
+        }
+    }
+    yarena_reset(&arena);
+
+    /* string columns outlive the refills of a tiny buffer */
+    fp = tmpfile();
+    if (!fp) FAIL("Failed to create column test file");
+    for (int i = 0; i < 2000; i++) fprintf(fp, "sym%d %d view%d\n", i % 37, i, i);
+    rewind(fp);
+    if (!ycolumns_init(&t, "%s %d %S", &arena)) FAIL("String column schema rejected");
+    yreader_init_file(&r, fp);
+    yreader_set_alloc(&r, YBUF_MALLOC, 16);
+    if (ycolumns_read_r(&r, &t, 0) != 2000) FAIL("String column row count mismatch");
+    yreader_close(&r);
+    fclose(fp);
+    ystr *syms = (ystr *)t.col[0], *views = (ystr *)t.col[2];
+    for (int i = 0; i < 2000; i++) {
+        char want[2][16];
+        sprintf(want[0], "sym%d", i % 37);
+        sprintf(want[1], "view%d", i);
+        if (((int *)t.col[1])[i] != i || strcmp(syms[i].ptr, want[0]) || views[i].len != strlen(want[1]) ||
+            strcmp(views[i].ptr, want[1])) {
+            yarena_free(&arena);
+            FAIL("String column value mismatch");
+        }
+    }
+    yarena_free(&arena);
+
+    PASS();
+}
+
+/* Test CSV/TSV delimited fields */
+static int field_is(const ystr *v, const char *want) {
+    return v->len == strlen(want) && memcmp(v->ptr, want, v->len) == 0;
+}
+
+void test_delimited_fields(void) {
+    TEST("delimited fields");
+
+    static const char *want[] = {"a", "b", "", "q,1", "x\"y", "", "", "", "last", "open"};
+    static const int eol[] = {0, 0, 0, 0, 1, 1, 0, 1, 0, 1};
+    const char *in = "a,b,,\"q,1\",\"x\"\"y\"\r\n\"\"\r\n,\nlast,\"open";
+    yreader r;
+    ystr v;
+    yreader_init_mem(&r, in, strlen(in));
+    if (!yreader_set_delim(&r, ",", '"')) FAIL("Delimiter setup failed");
+    for (size_t i = 0; i < sizeof(want) / sizeof(want[0]); i++) {
+        if (!ycsv_field_r(&r, &v) || !field_is(&v, want[i])) FAIL("CSV field mismatch");
+        if (ycsv_eol_r(&r) != eol[i]) FAIL("CSV record end mismatch");
+    }
+    if (ycsv_field_r(&r, &v)) FAIL("Field past end of input");
+    yreader_close(&r);
+
+    /* typed TSV fields; a trailing separator yields one more empty field */
+    in = "7\t-2.5\tx\n\t3\t";
+    int a;
+    double d;
+    yreader_init_mem(&r, in, strlen(in));
+    yreader_set_delim(&r, "\t", 0);
+    if (ycsv_int_r(&r, &a) != 1 || a != 7) FAIL("TSV int mismatch");
+    if (ycsv_double_r(&r, &d) != 1 || d != -2.5) FAIL("TSV double mismatch");
+    if (ycsv_int_r(&r, &a) != 0 || !ycsv_eol_r(&r)) FAIL("Malformed TSV field accepted");
+    if (ycsv_int_r(&r, &a) != 0) FAIL("Empty TSV field accepted");
+    if (ycsv_int_r(&r, &a) != 1 || a != 3 || ycsv_eol_r(&r)) FAIL("Second TSV row mismatch");
+    if (!ycsv_field_r(&r, &v) || v.len != 0 || !ycsv_eol_r(&r)) FAIL("Trailing empty field lost");
+    if (ycsv_int_r(&r, &a) != EOF) FAIL("TSV EOF not reported");
+    yreader_close(&r);
+
+    /* quoted and plain fields straddling refills of a small buffer */
+    FILE *fp = tmpfile();
+    if (!fp) FAIL("Failed to create CSV test file");
+    for (int i = 0; i < 3000; i++) fprintf(fp, "%d,\"name \"\"%d\"\", with comma\",%d.5\r\n", i, i, i);
+    rewind(fp);
+    yreader_init_file(&r, fp);
+    yreader_set_alloc(&r, YBUF_MALLOC, 64);
+    yreader_set_delim(&r, ",", '"');
+    for (int i = 0; i < 3000; i++) {
+        char name[64];
+        long long id;
+        sprintf(name, "name \"%d\", with comma", i);
+        if (ycsv_ll_r(&r, &id) != 1 || id != i || !ycsv_field_r(&r, &v) || !field_is(&v, name) ||
+            ycsv_double_r(&r, &d) != 1 || d != i + 0.5 || !ycsv_eol_r(&r)) {
+            yreader_close(&r);
+            fclose(fp);
+            FAIL("CSV row from file mismatch");
+        }
+    }
+    if (ycsv_field_r(&r, &v)) FAIL("Field after the last CSV row");
+    yreader_close(&r);
+    fclose(fp);
+
+    PASS();
+}
+
+/* Test zero-copy string views */
+void test_string_views(void) {
+    TEST("string views");
+
+    const char *in = "alpha  beta\tgamma 42";
+    yreader r;
+    yreader_init_mem(&r, in, strlen(in));
+
+    ystr a, b, c;
+    int n;
+    if (yscanf_r(&r, "%S %S", &a, &b) != 2) FAIL("Failed to read views");
+    if (a.len != 5 || memcmp(a.ptr, "alpha", 5) != 0) FAIL("First view mismatch");
+    if (b.len != 4 || memcmp(b.ptr, "beta", 4) != 0) FAIL("Second view mismatch");
+    if (a.ptr != in) FAIL("View is not zero-copy");
+    if (!yread_view_ok_r(&r, &c) || c.len != 5 || memcmp(c.ptr, "gamma", 5) != 0) FAIL("Third view mismatch");
+    if (!yread_int_ok_r(&r, &n) || n != 42) FAIL("Integer after views mismatch");
+    if (yread_view_ok_r(&r, &c)) FAIL("View past end of input");
+    yreader_close(&r);
+
+    /* a token straddling a refill is compacted, not lost */
+    FILE *fp = tmpfile();
+    if (!fp) FAIL("Failed to create view test file");
+    for (int i = 0; i < 20000; i++) fprintf(fp, "tok%d ", i);
+    rewind(fp);
+    yreader_init_file(&r, fp);
+    char want[32];
+    for (int i = 0; i < 20000; i++) {
+        int len = sprintf(want, "tok%d", i);
+        if (!yread_view_ok_r(&r, &c) || c.len != (size_t)len || memcmp(c.ptr, want, len) != 0) {
+            yreader_close(&r);
+            fclose(fp);
+            FAIL("View from file mismatch");
+        }
+    }
+    yreader_close(&r);
+    fclose(fp);
+
+    PASS();
+}
+
+/* Test the background prefetch reader (synchronous without YSCANF_PREFETCH) */
+void test_prefetch_reader(void) {
+    TEST("prefetch reader");
+
+    FILE *fp = tmpfile();
+    if (!fp) FAIL("Failed to create prefetch test file");
+    for (int i = 0; i < 50000; i++) fprintf(fp, "%d\n", i);
+    rewind(fp);
+
+    yreader r;
+    yreader_init_file(&r, fp);
+    yreader_prefetch(&r);
+
+    long long sum = 0, val;
+    int n = 0;
+    while (yread_ll_ok_r(&r, &val)) {
+        sum += val;
+        n++;
+    }
+    yreader_close(&r);
+    fclose(fp);
+
+    if (n != 50000) FAIL("Prefetch reader count mismatch");
+    if (sum != 1249975000LL) FAIL("Prefetch reader sum mismatch");
+
+    PASS();
+}
+
+#if defined(YSCANF_PARALLEL) && defined(YSCANF_HAVE_POSIX)
+/* Test parallel chunked parsing with ordered results */
+static long long par_sums[64];
+static size_t par_order;
+
+static int par_work(yreader *r, size_t chunk, void *ctx) {
+    long long val;
+    (void)ctx;
+    while (yread_ll_ok_r(r, &val)) par_sums[chunk] += val;
+    return 0;
+}
+
+static void par_emit(size_t chunk, void *ctx) {
+    if (chunk == par_order) par_order++;
+    *(long long *)ctx += par_sums[chunk];
+}
+
+void test_parallel_chunks(void) {
+    TEST("parallel chunks");
+
+    char in[4096];
+    size_t len = 0;
+    for (int i = 1; i <= 500; i++) len += sprintf(in + len, "%d\n", i);
+
+    long long total = 0;
+    long n = yparallel_mem(in, len, 4, len / 40, '\n', par_work, par_emit, &total);
+    if (n != (long)ypar_chunks(len, len / 40)) FAIL("Chunk count mismatch");
+    if (par_order != (size_t)n) FAIL("Chunks emitted out of order");
+    if (total != 125250) FAIL("Parallel sum mismatch");
+
+    PASS();
+}
+#endif
+
+/* Test the output writer by reading its output back */
+void test_writer_round_trip(void) {
+    TEST("writer round trip");
+
+    static char out[1 << 16];
+    ywriter w;
+    ywriter_init_mem(&w, out, sizeof(out));
+
+    double vals[] = {0.1, -2.5, 1e21, 1e-7, 5e-324, 1.7976931348623157e308, 123456.789, 0.0};
+    long long ints[] = {0, -1, 42, LLONG_MIN, LLONG_MAX};
+    for (size_t i = 0; i < sizeof(vals) / sizeof(vals[0]); i++) yprintf_r(&w, "%f ", vals[i]);
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) yprintf_r(&w, "%lld\n", ints[i]);
+    yprintf_r(&w, "%u %s %c%%", 4000000000u, "word", 'z');
+    if (w.err) FAIL("Writer reported an error");
+
+    yreader r;
+    yreader_init_mem(&r, out, (size_t)(w.ptr - out));
+    for (size_t i = 0; i < sizeof(vals) / sizeof(vals[0]); i++) {
+        double x;
+        if (!yread_double_ok_r(&r, &x) || memcmp(&x, &vals[i], sizeof(x)) != 0) FAIL("Double did not round-trip");
+    }
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        long long x;
+        if (!yread_ll_ok_r(&r, &x) || x != ints[i]) FAIL("Integer did not round-trip");
+    }
+    unsigned u;
+    char s[16];
+    if (!yread_uint_ok_r(&r, &u) || u != 4000000000u) FAIL("Unsigned did not round-trip");
+    if (!yread_str_ok_r(&r, s) || strcmp(s, "word") != 0) FAIL("String did not round-trip");
+    if (!yread_str_ok_r(&r, s) || strcmp(s, "z%") != 0) FAIL("Character and percent mismatch");
+
+    char small[4];
+    ywriter_init_mem(&w, small, sizeof(small));
+    if (ywrite_int_r(&w, 123456) != 4) FAIL("Full writer miscounted the stored bytes");
+    if (w.err != ENOSPC || w.ptr != small + 4 || memcmp(small, "1234", 4) != 0) FAIL("Full memory writer not reported");
+    ywriter_init_mem(&w, small, sizeof(small));
+    if (ywrite_int_r(&w, -1234567) != 4 || ywrite_char_r(&w, 'x') != 0) FAIL("Negative into a full writer miscounted");
+    char line[8];
+    ywriter_init_mem(&w, line, sizeof(line));
+    if (yprintf_r(&w, "%d %s %.2f", 12, "abc", 3.14159) != 8 || memcmp(line, "12 abc 3", 8) != 0)
+        FAIL("yprintf_r over-reported on ENOSPC");
+
+    /* precisions match printf; %.Ns never reads past N bytes of an unterminated buffer */
+    char got[128], want[128];
+    const char raw[5] = {'a', 'b', 'c', 'd', 'e'};
+    ywriter_init_mem(&w, got, sizeof(got));
+    int n = yprintf_r(&w, "[%.3d|%.5d|%.0d|%.1d|%.22lld|%.4u|%.2llu|%.3s|%.10s|%.0s]", 7, -42, 0, 0, LLONG_MIN,
+                      12u, 123456ULL, raw, "hi", "x");
+    int m = snprintf(want, sizeof(want), "[%.3d|%.5d|%.0d|%.1d|%.22lld|%.4u|%.2llu|%.3s|%.10s|%.0s]", 7, -42, 0, 0,
+                     LLONG_MIN, 12u, 123456ULL, raw, "hi", "x");
+    if (n != m || memcmp(got, want, (size_t)m) != 0) FAIL("Precision output differs from printf");
+    if (yprintf_r(&w, "%.2c", 'x') != -1) FAIL("Precision on %c accepted");
+
+    PASS();
+}
+
+/* Test the YSCANF_STATS counters (all zero in default builds) */
+void test_stats_counters(void) {
+    TEST("stats counters");
+
+    const char *in = "1 22  333\n4.5 word x";
+    yreader r;
+    yreader_init_mem(&r, in, strlen(in));
+
+    int a;
+    long long b;
+    unsigned c;
+    double d;
+    char s[16], ch;
+    if (yscanf_r(&r, "%d %lld %u %f %s %c", &a, &b, &c, &d, s, &ch) != 6) FAIL("Failed to read stats input");
+
+    const ystats *st = yreader_stats(&r);
+#ifdef YSCANF_STATS
+    if (st->ints != 2 || st->lls != 1 || st->doubles != 1 || st->strs != 1 || st->chars != 1)
+        FAIL("Token counters mismatch");
+    if (st->ws_bytes != 6) FAIL("Whitespace counter mismatch");
+#else
+    if (st->ints || st->lls || st->ws_bytes) FAIL("Counters moved without YSCANF_STATS");
+#endif
+    yreader_close(&r);
+
+#ifdef YSCANF_STATS
+    /* 3-byte chunks: "11 " "22 " ... split no token, however often a mark holds them */
+    struct chunk_src cs = {"11 22 33 44", 11, 3, 0};
+    long long v;
+    yreader_init_fn(&r, chunk_read, &cs);
+    for (int i = 0; i < 4; i++) {
+        yreader_mark(&r);
+        if (!yread_ll_ok_r(&r, &v) || !yreader_rewind(&r) || !yread_ll_ok_r(&r, &v)) FAIL("Marked read failed");
+        yreader_unmark(&r);
+    }
+    if (yreader_stats(&r)->straddles != 0) FAIL("Straddles counted without a split token");
+    yreader_close(&r);
+
+    /* "123" "4 5" "678" "9ab" "c": 1234 once, then 56789abc in a view three times */
+    ystr view;
+    cs.p = "1234 56789abc";
+    cs.left = 13;
+    yreader_init_fn(&r, chunk_read, &cs);
+    if (!yread_ll_ok_r(&r, &v) || v != 1234 || !yread_view_ok_r(&r, &view) || view.len != 8)
+        FAIL("Split tokens misread");
+    if (yreader_stats(&r)->straddles != 4) FAIL("Straddle count mismatch");
+    yreader_close(&r);
+#endif
+
+    PASS();
+}
+
+/* Test per-reader buffer sizes and allocation strategies */
+void test_buffer_strategies(void) {
+    TEST("buffer strategies");
+
+    FILE *fp = tmpfile();
+    if (!fp) FAIL("Failed to create buffer test file");
+    for (int i = 0; i < 20000; i++) fprintf(fp, "%d word%d\n", i, i);
+
+    static char user_buf[64];
+    int modes[] = {-1, YBUF_MALLOC, YBUF_ALIGNED, YBUF_HUGE, YBUF_AUTO};
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        yreader r;
+        rewind(fp);
+        yreader_init_file(&r, fp);
+        if (modes[m] < 0) {
+            if (!yreader_set_buffer(&r, user_buf, sizeof(user_buf))) FAIL("Caller buffer rejected");
+        } else if (!yreader_set_alloc(&r, modes[m], 1000)) {
+            FAIL("Allocation mode rejected");
+        }
+
+        long long sum = 0;
+        int n = 0, x;
+        ystr w;
+        while (yread_int_ok_r(&r, &x) && yread_view_ok_r(&r, &w)) {
+            sum += x;
+            n++;
+        }
+        if (n != 20000 || sum != 199990000LL) FAIL("Read mismatch with custom buffer");
+        if (yreader_set_alloc(&r, YBUF_MALLOC, 0)) FAIL("Buffer changed after the first read");
+        yreader_close(&r);
+    }
+    fclose(fp);
+
+    PASS();
+}
+
 /* Performance test */
 void test_performance(void) {
     TEST("performance");
@@ -268,11 +1511,12 @@ void test_performance(void) {
     
     /* Redirect stdin */
     freopen("perf_test.txt", "r", stdin);
+    yscanf_reset();
     
     /* Time the parsing */
     clock_t start = clock();
     
-    int sum = 0;
+    long long sum = 0;
     int val;
     while (yscanf("%d", &val) == 1) {
         sum += val;
@@ -282,7 +1526,7 @@ void test_performance(void) {
     double cpu_time = ((double)(end - start)) / CLOCKS_PER_SEC;
     
     printf("\n    Parsed 100,000 integers in %.3f seconds\n", cpu_time);
-    printf("    Sum: %d (verification: %s)\n", sum, 
+    printf("    Sum: %lld (verification: %s)\n", sum, 
            (sum == 4999950000LL) ? "CORRECT" : "INCORRECT");
     
     if (sum != 4999950000LL) {
@@ -302,12 +1546,42 @@ int main(void) {
     test_long_long();
     test_unsigned_long_long();
     test_floating_point();
+    test_float_rounding();
     test_string_reading();
     test_character_reading();
+    test_bounded_strings();
     test_whitespace_handling();
+    test_char_classes();
     test_overflow_handling();
+    test_overflow_policies();
+    test_integer_bounds();
     test_eof_handling();
     test_mixed_types();
+    test_reader_context();
+    test_callback_source();
+    test_float_refill_edges();
+    test_decompress_source();
+    test_padded_buffers();
+    test_mark_rewind();
+    test_merge_streams();
+    test_format_cache();
+#ifdef YSCAN_R
+    test_generic_scan();
+#endif
+    test_arena_strings();
+    test_kernel_variants();
+    test_array_readers();
+    test_line_records();
+    test_columns();
+    test_delimited_fields();
+    test_string_views();
+    test_writer_round_trip();
+    test_stats_counters();
+    test_buffer_strategies();
+    test_prefetch_reader();
+#if defined(YSCANF_PARALLEL) && defined(YSCANF_HAVE_POSIX)
+    test_parallel_chunks();
+#endif
     test_performance();
     
     /* Summary */
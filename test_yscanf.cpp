@@ -0,0 +1,177 @@
+/**
+ * @file test_yscanf.cpp
+ * @brief Tests for the compile-time format front end in yscanf.hpp
+ *
+ *   g++ -std=c++17 -O2 test_yscanf.cpp -o test_yscanf_cpp
+ *   g++ -std=c++20 -O2 test_yscanf.cpp -o test_yscanf_cpp   (adds ys::scan<"...">)
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "yscanf.hpp"
+
+/* Test result tracking */
+static int tests_run = 0;
+static int tests_passed = 0;
+
+#define TEST(name) \
+    do { \
+        printf("Testing %s... ", name); \
+        fflush(stdout); \
+        tests_run++; \
+    } while (0)
+
+#define PASS() \
+    do { \
+        printf("PASSED\n"); \
+        tests_passed++; \
+    } while (0)
+
+/* ends the current test; the summary counts it as failed */
+#define FAIL(msg) \
+    do { \
+        printf("FAILED: %s\n", msg); \
+        return; \
+    } while (0)
+
+/* Test every specifier the compile-time parser accepts */
+static void test_specifiers() {
+    TEST("compiled specifiers");
+
+    const char *in = "-12 34 -9000000000 18000000000000000000 2.5 -1e3 7.25 6e-1 word longword abc123 xyz view Q";
+    yreader r;
+    int i;
+    unsigned u;
+    long long ll;
+    unsigned long long ull;
+    double f, lf, e, g;
+    char s[16], s5[8], set[16], set3[8];
+    ystr v;
+    char c;
+    yreader_init_mem(&r, in, strlen(in));
+    int n = YSCANF_R(&r, "%d %u %lld %llu %f %lf", &i, &u, &ll, &ull, &f, &lf);
+    if (n != 6) FAIL("Numeric specifiers read the wrong count");
+    if (i != -12 || u != 34 || ll != -9000000000LL || ull != 18000000000000000000ULL) FAIL("Integer mismatch");
+    if (f != 2.5 || lf != -1000.0) FAIL("Double mismatch");
+    /* literal text in the format is ignored, as in yscanf() */
+    n = YSCANF_R(&r, "%e, %g", &e, &g);
+    if (n != 2 || e != 7.25 || g != 0.6) FAIL("Format with a literal mismatch");
+    n = YSCANF_R(&r, "%s %5s", s, s5);
+    if (n != 2 || strcmp(s, "word") != 0 || strcmp(s5, "longw") != 0) FAIL("String specifiers mismatch");
+    n = YSCANF_R(&r, "%s %[a-z0-9] %3[a-z]", s, set, set3);
+    if (n != 3 || strcmp(s, "ord") != 0 || strcmp(set, "abc123") != 0 || strcmp(set3, "xyz") != 0)
+        FAIL("Scanset specifiers mismatch");
+    n = YSCANF_R(&r, "%S%c", &v, &c);
+    if (n != 2 || v.len != 4 || memcmp(v.ptr, "view", 4) != 0 || c != ' ') FAIL("View or char mismatch");
+    n = YSCANF_R(&r, "%c", &c);
+    if (n != 1 || c != 'Q') FAIL("Char after the view mismatch");
+    yreader_close(&r);
+
+    PASS();
+}
+
+/* Test that compile-time scansets build the same tables as yset_compile() */
+static void test_set_tables() {
+    TEST("compiled scanset tables");
+
+    static const char *const specs[] = {"[a-z0-9]", "[^,]", "[^]x]", "[]a-]", "[acegi]", "[\x01-\x7f]"};
+    for (const char *spec : specs) {
+        yset a = {}, b = {};
+        if (!yset_compile(&a, spec) || !ys::detail::compile_set(b, spec, 0)) FAIL("Scanset rejected");
+        if (memcmp(&a, &b, sizeof(a)) != 0) FAIL("Compile-time scanset differs from yset_compile()");
+    }
+
+    PASS();
+}
+
+/* Test the count on a matching failure and EOF on an empty input */
+static void test_failures() {
+    TEST("compiled failures");
+
+    yreader r;
+    int a = 0, b = 0;
+    double d = 0;
+    yreader_init_mem(&r, "5 x 6", 5);
+    if (YSCANF_R(&r, "%d %d %lf", &a, &b, &d) != 1 || a != 5) FAIL("Mismatch count wrong");
+    char s[8];
+    if (YSCANF_R(&r, "%s %d", s, &b) != 2 || strcmp(s, "x") != 0 || b != 6) FAIL("Read after mismatch wrong");
+    if (YSCANF_R(&r, "%d", &a) != EOF) FAIL("EOF not reported");
+    yreader_close(&r);
+
+    yreader_init_mem(&r, "abc", 3);
+    if (YSCANF_R(&r, "%d", &a) != EOF) FAIL("Failed first item not EOF");
+    yreader_close(&r);
+
+    PASS();
+}
+
+struct chunk_src {
+    const char *p;
+    size_t left;
+};
+
+static size_t chunk_read(void *ctx, char *buf, size_t cap) {
+    chunk_src *c = static_cast<chunk_src *>(ctx);
+    size_t n = c->left < 3 ? c->left : 3;
+    if (n > cap) n = cap;
+    memcpy(buf, c->p, n);
+    c->p += n;
+    c->left -= n;
+    return n;
+}
+
+/* Test tokens split across refills of a callback source */
+static void test_refills() {
+    TEST("compiled refills");
+
+    const char *in = "123456789 -3.14159 abcdefgh 4294967295";
+    chunk_src src = {in, strlen(in)};
+    yreader r;
+    int i;
+    double d;
+    char s[16];
+    unsigned u;
+    yreader_init_fn(&r, chunk_read, &src);
+    yreader_set_alloc(&r, YBUF_MALLOC, 8);
+    if (YSCANF_R(&r, "%d %lf %s %u", &i, &d, s, &u) != 4) FAIL("Straddling tokens read the wrong count");
+    if (i != 123456789 || d != -3.14159 || strcmp(s, "abcdefgh") != 0 || u != 4294967295u)
+        FAIL("Straddling tokens mismatch");
+    yreader_close(&r);
+
+    PASS();
+}
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+/* Test the C++20 literal form */
+static void test_literal_form() {
+    TEST("C++20 literal formats");
+
+    yreader r;
+    long long a;
+    char s[8];
+    yreader_init_mem(&r, "77 tail", 7);
+    if (ys::scan<"%lld %7s">(&r, &a, s) != 2 || a != 77 || strcmp(s, "tail") != 0) FAIL("Literal format mismatch");
+    if (ys::scan<"%lld">(&r, &a) != EOF) FAIL("Literal format EOF not reported");
+    yreader_close(&r);
+
+    PASS();
+}
+#endif
+
+int main() {
+    printf("=== yscanf.hpp Test Suite ===\n\n");
+
+    test_specifiers();
+    test_set_tables();
+    test_failures();
+    test_refills();
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+    test_literal_form();
+#endif
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests run: %d\n", tests_run);
+    printf("Tests passed: %d\n", tests_passed);
+    return tests_passed == tests_run ? 0 : 1;
+}
@@ -0,0 +1,663 @@
+/**
+ * @file yprintf.h
+ * @brief Buffered output writer, the companion of yscanf.h
+ * @author Summer PLUS Studio
+ * @email yuzhouhunter@outlook.com
+ * @version 3.0
+ *
+ * Output mirrors the reader design: all state lives in a ywriter bound to
+ * stdout, a FILE*, a file descriptor or a caller buffer. Integers are
+ * formatted two digits per step from a lookup table; doubles print the
+ * shortest digit string that reads back to the same value (Grisu2). The
+ * default writer flushes itself at exit; other writers need yflush_r() or
+ * ywriter_close().
+ */
+
+#ifndef YPRINTF_H
+#define YPRINTF_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+/* ========================= CONFIG ========================= */
+
+#ifndef YPRINTF_BUFFER_SIZE
+#define YPRINTF_BUFFER_SIZE (1 << 20)
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define YP_LIKELY(x)   __builtin_expect(!!(x),1)
+#define YP_UNLIKELY(x) __builtin_expect(!!(x),0)
+#define YP_COLD        __attribute__((noinline,cold,unused))
+#else
+#define YP_LIKELY(x)   (x)
+#define YP_UNLIKELY(x) (x)
+#define YP_COLD
+#endif
+
+/* strict ISO modes (-std=c11) hide write(2) unless asked for */
+#if (defined(__unix__)||defined(__APPLE__))&&(!defined(__STRICT_ANSI__)|| \
+	defined(_POSIX_C_SOURCE)||defined(_XOPEN_SOURCE)||defined(_DEFAULT_SOURCE)||defined(_GNU_SOURCE))
+#define YPRINTF_HAVE_POSIX 1
+#include <unistd.h>
+#endif
+
+/* ========================= WRITER ========================= */
+
+/*
+ * The buffer is allocated on the first flush-worthy write. A memory writer
+ * fills the caller's buffer and sets err to ENOSPC once it is full; ptr
+ * minus the buffer start is the length written.
+ */
+enum{YDST_STDOUT,YDST_FILE,YDST_FD,YDST_MEM};
+
+typedef struct ywriter{
+	char *ptr,*end;
+	char *buf;
+	size_t cap;
+	int dst;
+	FILE *fp;
+	int fd;
+	int err;
+}ywriter;
+
+static ywriter ystd_writer;
+
+static inline ywriter *ystdout(void)
+{
+	return &ystd_writer;
+}
+
+static inline void ywriter_init_file(ywriter *w,FILE *fp)
+{
+	memset(w,0,sizeof(*w));
+	w->dst=YDST_FILE;
+	w->fp=fp;
+}
+
+#ifdef YPRINTF_HAVE_POSIX
+static inline void ywriter_init_fd(ywriter *w,int fd)
+{
+	memset(w,0,sizeof(*w));
+	w->dst=YDST_FD;
+	w->fd=fd;
+}
+#endif
+
+static inline void ywriter_init_mem(ywriter *w,void *buf,size_t cap)
+{
+	memset(w,0,sizeof(*w));
+	w->dst=YDST_MEM;
+	w->buf=w->ptr=(char*)buf;
+	w->end=w->buf+cap;
+	w->cap=cap;
+}
+
+/* ========================= SINK ========================= */
+
+static YP_COLD void ysink_r(ywriter *w,const char *p,size_t n)
+{
+#ifdef YPRINTF_HAVE_POSIX
+	if(w->dst!=YDST_FILE){
+		int fd=w->dst==YDST_FD?w->fd:STDOUT_FILENO;
+		/* keep order with anything already printed through stdio */
+		if(w->dst==YDST_STDOUT)fflush(stdout);
+		while(n){
+			ssize_t k=write(fd,p,n);
+			if(k<0){
+				if(errno==EINTR)continue;
+				w->err=errno;
+				return;
+			}
+			p+=k;
+			n-=(size_t)k;
+		}
+		return;
+	}
+#endif
+	if(fwrite(p,1,n,w->dst==YDST_FILE?w->fp:stdout)!=n)w->err=errno?errno:EIO;
+}
+
+static inline void yflush_r(ywriter *w)
+{
+	if(w->dst==YDST_MEM||!w->buf)return;
+	if(w->ptr>w->buf)ysink_r(w,w->buf,(size_t)(w->ptr-w->buf));
+	if(w->dst==YDST_FILE)fflush(w->fp);
+	w->ptr=w->buf;
+}
+
+static void ystd_writer_exit(void)
+{
+	yflush_r(&ystd_writer);
+}
+
+/* flushes or allocates until n bytes fit; 0 if they never will */
+static YP_COLD int yw_room_r(ywriter *w,size_t n)
+{
+	if(w->dst==YDST_MEM)return 0;
+	if(!w->buf){
+		if(!(w->buf=(char*)malloc(YPRINTF_BUFFER_SIZE))){w->err=ENOMEM;return 0;}
+		w->cap=YPRINTF_BUFFER_SIZE;
+		w->ptr=w->buf;
+		w->end=w->buf+w->cap;
+		if(w==&ystd_writer){
+			static int hooked;
+			if(!hooked)hooked=!atexit(ystd_writer_exit);
+		}
+	}
+	else yflush_r(w);
+	return w->cap>=n;
+}
+
+/* returns the bytes taken: fewer than n only when a memory writer fills up */
+static YP_COLD size_t yput_slow_r(ywriter *w,const char *p,size_t n)
+{
+	size_t k;
+	if(yw_room_r(w,n)){
+		memcpy(w->ptr,p,n);
+		w->ptr+=n;
+		return n;
+	}
+	if(w->dst!=YDST_MEM&&w->buf){
+		/* larger than the whole buffer: straight to the sink */
+		ysink_r(w,p,n);
+		return n;
+	}
+	k=(size_t)(w->end-w->ptr);
+	if(k>n)k=n;
+	if(k){
+		memcpy(w->ptr,p,k);
+		w->ptr+=k;
+	}
+	/* a failed allocation has already set ENOMEM */
+	if(w->dst==YDST_MEM)w->err=ENOSPC;
+	return k;
+}
+
+/*
+ * Every ywrite_*_r() returns the bytes stored: the text length, or what
+ * still fit once a memory writer runs out of room (err is then ENOSPC).
+ */
+static inline int ywrite_bytes_r(ywriter *w,const void *p,size_t n)
+{
+	if(YP_LIKELY((size_t)(w->end-w->ptr)>=n)){
+		memcpy(w->ptr,p,n);
+		w->ptr+=n;
+		return (int)n;
+	}
+	return (int)yput_slow_r(w,(const char*)p,n);
+}
+
+/* releases the buffer after a flush; the FILE* or fd is left open */
+static inline void ywriter_close(ywriter *w)
+{
+	yflush_r(w);
+	if(w->dst!=YDST_MEM)free(w->buf);
+	memset(w,0,sizeof(*w));
+}
+
+/* ========================= INTEGERS ========================= */
+
+static const char yp_digits2[201]=
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+static inline int yp_ndigits(unsigned long long x)
+{
+	int n=1;
+	for(;;){
+		if(x<10)return n;
+		if(x<100)return n+1;
+		if(x<1000)return n+2;
+		if(x<10000)return n+3;
+		x/=10000;
+		n+=4;
+	}
+}
+
+/* writes x so that its last digit is at e[-1] */
+static inline void yp_utoa(char *e,unsigned long long x)
+{
+	unsigned y;
+	while(x>0xffffffffULL){
+		unsigned i=(unsigned)(x%100)*2;
+		x/=100;
+		e-=2;
+		memcpy(e,yp_digits2+i,2);
+	}
+	/* the rest fits 32 bits, where the divides are cheaper */
+	y=(unsigned)x;
+	while(y>=100){
+		unsigned i=(y%100)*2;
+		y/=100;
+		e-=2;
+		memcpy(e,yp_digits2+i,2);
+	}
+	if(y>=10){e-=2;memcpy(e,yp_digits2+y*2,2);}
+	else *--e=(char)('0'+y);
+}
+
+static inline int yp_write_uint_r(ywriter *w,unsigned long long x,int neg)
+{
+	int n=yp_ndigits(x)+neg;
+	char t[24],*p=t;
+	if(YP_LIKELY(w->end-w->ptr>=n)||yw_room_r(w,(size_t)n))p=w->ptr;
+	*p='-';
+	yp_utoa(p+n,x);
+	if(p==t)return ywrite_bytes_r(w,t,(size_t)n);
+	w->ptr+=n;
+	return n;
+}
+
+static inline int ywrite_ull_r(ywriter *w,unsigned long long x)
+{
+	return yp_write_uint_r(w,x,0);
+}
+
+static inline int ywrite_ll_r(ywriter *w,long long x)
+{
+	unsigned long long u=(unsigned long long)x;
+	return x<0?yp_write_uint_r(w,0-u,1):yp_write_uint_r(w,u,0);
+}
+
+static inline int ywrite_uint_r(ywriter *w,unsigned x){return ywrite_ull_r(w,x);}
+static inline int ywrite_int_r(ywriter *w,int x){return ywrite_ll_r(w,x);}
+
+/* ========================= DOUBLES ========================= */
+
+/*
+ * Grisu2 (Loitsch, "Printing Floating-Point Numbers Quickly and
+ * Accurately with Integers"): the digits always read back to the same
+ * double and are the shortest such string for all but a tiny fraction of
+ * inputs, where one extra digit may appear.
+ */
+typedef struct yp_fp{
+	unsigned long long f;
+	int e;
+}yp_fp;
+
+/* 10^k for k=-348,-340,...,340, normalized to 64 bits and rounded */
+static const yp_fp yp_cached[87]={
+	{0xfa8fd5a0081c0288ULL,-1220},{0xbaaee17fa23ebf76ULL,-1193},
+	{0x8b16fb203055ac76ULL,-1166},{0xcf42894a5dce35eaULL,-1140},
+	{0x9a6bb0aa55653b2dULL,-1113},{0xe61acf033d1a45dfULL,-1087},
+	{0xab70fe17c79ac6caULL,-1060},{0xff77b1fcbebcdc4fULL,-1034},
+	{0xbe5691ef416bd60cULL,-1007},{0x8dd01fad907ffc3cULL,-980},
+	{0xd3515c2831559a83ULL,-954},{0x9d71ac8fada6c9b5ULL,-927},
+	{0xea9c227723ee8bcbULL,-901},{0xaecc49914078536dULL,-874},
+	{0x823c12795db6ce57ULL,-847},{0xc21094364dfb5637ULL,-821},
+	{0x9096ea6f3848984fULL,-794},{0xd77485cb25823ac7ULL,-768},
+	{0xa086cfcd97bf97f4ULL,-741},{0xef340a98172aace5ULL,-715},
+	{0xb23867fb2a35b28eULL,-688},{0x84c8d4dfd2c63f3bULL,-661},
+	{0xc5dd44271ad3cdbaULL,-635},{0x936b9fcebb25c996ULL,-608},
+	{0xdbac6c247d62a584ULL,-582},{0xa3ab66580d5fdaf6ULL,-555},
+	{0xf3e2f893dec3f126ULL,-529},{0xb5b5ada8aaff80b8ULL,-502},
+	{0x87625f056c7c4a8bULL,-475},{0xc9bcff6034c13053ULL,-449},
+	{0x964e858c91ba2655ULL,-422},{0xdff9772470297ebdULL,-396},
+	{0xa6dfbd9fb8e5b88fULL,-369},{0xf8a95fcf88747d94ULL,-343},
+	{0xb94470938fa89bcfULL,-316},{0x8a08f0f8bf0f156bULL,-289},
+	{0xcdb02555653131b6ULL,-263},{0x993fe2c6d07b7facULL,-236},
+	{0xe45c10c42a2b3b06ULL,-210},{0xaa242499697392d3ULL,-183},
+	{0xfd87b5f28300ca0eULL,-157},{0xbce5086492111aebULL,-130},
+	{0x8cbccc096f5088ccULL,-103},{0xd1b71758e219652cULL,-77},
+	{0x9c40000000000000ULL,-50},{0xe8d4a51000000000ULL,-24},
+	{0xad78ebc5ac620000ULL,3},{0x813f3978f8940984ULL,30},
+	{0xc097ce7bc90715b3ULL,56},{0x8f7e32ce7bea5c70ULL,83},
+	{0xd5d238a4abe98068ULL,109},{0x9f4f2726179a2245ULL,136},
+	{0xed63a231d4c4fb27ULL,162},{0xb0de65388cc8ada8ULL,189},
+	{0x83c7088e1aab65dbULL,216},{0xc45d1df942711d9aULL,242},
+	{0x924d692ca61be758ULL,269},{0xda01ee641a708deaULL,295},
+	{0xa26da3999aef774aULL,322},{0xf209787bb47d6b85ULL,348},
+	{0xb454e4a179dd1877ULL,375},{0x865b86925b9bc5c2ULL,402},
+	{0xc83553c5c8965d3dULL,428},{0x952ab45cfa97a0b3ULL,455},
+	{0xde469fbd99a05fe3ULL,481},{0xa59bc234db398c25ULL,508},
+	{0xf6c69a72a3989f5cULL,534},{0xb7dcbf5354e9beceULL,561},
+	{0x88fcf317f22241e2ULL,588},{0xcc20ce9bd35c78a5ULL,614},
+	{0x98165af37b2153dfULL,641},{0xe2a0b5dc971f303aULL,667},
+	{0xa8d9d1535ce3b396ULL,694},{0xfb9b7cd9a4a7443cULL,720},
+	{0xbb764c4ca7a44410ULL,747},{0x8bab8eefb6409c1aULL,774},
+	{0xd01fef10a657842cULL,800},{0x9b10a4e5e9913129ULL,827},
+	{0xe7109bfba19c0c9dULL,853},{0xac2820d9623bf429ULL,880},
+	{0x80444b5e7aa7cf85ULL,907},{0xbf21e44003acdd2dULL,933},
+	{0x8e679c2f5e44ff8fULL,960},{0xd433179d9c8cb841ULL,986},
+	{0x9e19db92b4e31ba9ULL,1013},{0xeb96bf6ebadf77d9ULL,1039},
+	{0xaf87023b9bf0ee6bULL,1066}
+};
+
+static const unsigned long long yp_pow10[20]={
+	1ULL,10ULL,100ULL,1000ULL,10000ULL,100000ULL,1000000ULL,10000000ULL,100000000ULL,
+	1000000000ULL,10000000000ULL,100000000000ULL,1000000000000ULL,10000000000000ULL,
+	100000000000000ULL,1000000000000000ULL,10000000000000000ULL,100000000000000000ULL,
+	1000000000000000000ULL,10000000000000000000ULL
+};
+
+static inline yp_fp yp_mul(yp_fp x,yp_fp y)
+{
+	yp_fp r;
+#if defined(__SIZEOF_INT128__)
+	__extension__ typedef unsigned __int128 yp_u128;
+	yp_u128 p=(yp_u128)x.f*y.f;
+	r.f=(unsigned long long)(p>>64)+((unsigned long long)p>>63);
+#else
+	unsigned long long a=x.f>>32,b=x.f&0xffffffffULL,c=y.f>>32,d=y.f&0xffffffffULL;
+	unsigned long long ac=a*c,bc=b*c,ad=a*d,bd=b*d;
+	unsigned long long mid=(bd>>32)+(ad&0xffffffffULL)+(bc&0xffffffffULL);
+	mid+=1ULL<<31;	/* round */
+	r.f=ac+(ad>>32)+(bc>>32)+(mid>>32);
+#endif
+	r.e=x.e+y.e+64;
+	return r;
+}
+
+static inline yp_fp yp_norm(yp_fp x)
+{
+#if defined(__GNUC__)||defined(__clang__)
+	int s=__builtin_clzll(x.f);
+	x.f<<=s;
+	x.e-=s;
+#else
+	while(!(x.f&0x8000000000000000ULL)){x.f<<=1;x.e--;}
+#endif
+	return x;
+}
+
+/* a cached power c with c*2^e landing in [2^-60,2^-32]; *k is its decimal exponent negated */
+static inline yp_fp yp_cached_pow(int e,int *k)
+{
+	double dk=(-61-e)*0.30102999566398114+347;
+	int i=(int)dk;
+	if(dk-i>0.0)i++;
+	i=(i>>3)+1;
+	*k=348-i*8;
+	return yp_cached[i];
+}
+
+static inline void yp_round(char *buf,int len,unsigned long long delta,unsigned long long rest,
+	unsigned long long ten_k,unsigned long long wp_w)
+{
+	while(rest<wp_w&&delta-rest>=ten_k&&(rest+ten_k<wp_w||wp_w-rest>rest+ten_k-wp_w)){
+		buf[len-1]--;
+		rest+=ten_k;
+	}
+}
+
+static inline int yp_gen(yp_fp w,yp_fp mp,unsigned long long delta,char *buf,int *k)
+{
+	int sh=-mp.e,kappa,len=0;
+	unsigned long long one=1ULL<<sh,wp_w=mp.f-w.f,p2=mp.f&(one-1);
+	unsigned p1=(unsigned)(mp.f>>sh);
+	kappa=yp_ndigits(p1);
+	while(kappa>0){
+		unsigned pw=(unsigned)yp_pow10[kappa-1],d=p1/pw;
+		unsigned long long rest;
+		p1%=pw;
+		if(d||len)buf[len++]=(char)('0'+d);
+		kappa--;
+		rest=((unsigned long long)p1<<sh)+p2;
+		if(rest<=delta){
+			*k+=kappa;
+			yp_round(buf,len,delta,rest,yp_pow10[kappa]<<sh,wp_w);
+			return len;
+		}
+	}
+	for(;;){
+		unsigned d;
+		p2*=10;
+		delta*=10;
+		d=(unsigned)(p2>>sh);
+		if(d||len)buf[len++]=(char)('0'+d);
+		p2&=one-1;
+		kappa--;
+		if(p2<delta){
+			*k+=kappa;
+			yp_round(buf,len,delta,p2,one,-kappa<20?wp_w*yp_pow10[-kappa]:0);
+			return len;
+		}
+	}
+}
+
+/* digits of a finite x>0 into buf; x = digits * 10^*k */
+static inline int yp_grisu2(double x,char *buf,int *k)
+{
+	unsigned long long bits,f;
+	int be,n;
+	yp_fp v,pl,mi,c,w,wp,wm;
+	memcpy(&bits,&x,8);
+	f=bits&0xfffffffffffffULL;
+	be=(int)(bits>>52)&0x7ff;
+	if(be){v.f=f|0x10000000000000ULL;v.e=be-1075;}
+	else{v.f=f;v.e=-1074;}
+	pl.f=(v.f<<1)+1;
+	pl.e=v.e-1;
+	pl=yp_norm(pl);
+	if(v.f==0x10000000000000ULL){mi.f=(v.f<<2)-1;mi.e=v.e-2;}
+	else{mi.f=(v.f<<1)-1;mi.e=v.e-1;}
+	mi.f<<=mi.e-pl.e;
+	mi.e=pl.e;
+	c=yp_cached_pow(pl.e,k);
+	w=yp_mul(yp_norm(v),c);
+	wp=yp_mul(pl,c);
+	wm=yp_mul(mi,c);
+	wm.f++;
+	wp.f--;
+	n=yp_gen(w,wp,wp.f-wm.f,buf,k);
+	return n;
+}
+
+/*
+ * Places the point like JavaScript's Number#toString: plain notation for
+ * 1e-6 <= |x| < 1e21 (integers print without a fraction), otherwise
+ * d.ddde+NN. buf must hold 32 bytes.
+ */
+static inline int yp_format(char *buf,int len,int k)
+{
+	int kk=len+k,i;
+	if(k>=0&&kk<=21){
+		for(i=len;i<kk;i++)buf[i]='0';
+		return kk;
+	}
+	if(kk>0&&kk<=21){
+		memmove(buf+kk+1,buf+kk,(size_t)(len-kk));
+		buf[kk]='.';
+		return len+1;
+	}
+	if(kk>-6&&kk<=0){
+		int off=2-kk;
+		memmove(buf+off,buf,(size_t)len);
+		buf[0]='0';
+		buf[1]='.';
+		for(i=2;i<off;i++)buf[i]='0';
+		return len+off;
+	}
+	if(len>1){
+		memmove(buf+2,buf+1,(size_t)(len-1));
+		buf[1]='.';
+		len++;
+	}
+	buf[len++]='e';
+	kk--;
+	if(kk<0){buf[len++]='-';kk=-kk;}
+	else buf[len++]='+';
+	if(kk>=100){buf[len++]=(char)('0'+kk/100);kk%=100;memcpy(buf+len,yp_digits2+kk*2,2);len+=2;}
+	else if(kk>=10){memcpy(buf+len,yp_digits2+kk*2,2);len+=2;}
+	else buf[len++]=(char)('0'+kk);
+	return len;
+}
+
+/* shortest round-trip text of x; returns the length, buf holds 33 bytes */
+static inline int yp_dtoa(double x,char *buf)
+{
+	unsigned long long bits;
+	int neg,k,len;
+	memcpy(&bits,&x,8);
+	neg=(int)(bits>>63);
+	if(((bits>>52)&0x7ff)==0x7ff){
+		if(bits&0xfffffffffffffULL){memcpy(buf,"nan",3);return 3;}
+		memcpy(buf,"-inf"+!neg,4-!neg);
+		return 4-!neg;
+	}
+	*buf='-';
+	buf+=neg;
+	if(!(bits<<1)){*buf='0';return neg+1;}
+	len=yp_grisu2(neg?-x:x,buf,&k);
+	return neg+yp_format(buf,len,k);
+}
+
+static inline int ywrite_double_r(ywriter *w,double x)
+{
+	char t[40];
+	return ywrite_bytes_r(w,t,(size_t)yp_dtoa(x,t));
+}
+
+/* ========================= OTHER WRITES ========================= */
+
+static inline int ywrite_char_r(ywriter *w,char c)
+{
+	if(YP_LIKELY(w->ptr<w->end)){
+		*w->ptr++=c;
+		return 1;
+	}
+	return ywrite_bytes_r(w,&c,1);
+}
+
+static inline int ywrite_str_r(ywriter *w,const char *s)
+{
+	return ywrite_bytes_r(w,s,strlen(s));
+}
+
+/* ========================= YPRINTF ========================= */
+
+/* %.Nd: at least prec digits, zero-padded after the sign; %.0d of 0 prints nothing */
+static YP_COLD int yp_write_prec_r(ywriter *w,unsigned long long x,int neg,int prec)
+{
+	static const char zeros[]="00000000000000000000000000000000";
+	int pad=prec-yp_ndigits(x),cnt=0;
+	if(!prec&&!x)return 0;
+	if(neg)cnt+=ywrite_char_r(w,'-');
+	for(;pad>0;pad-=32)cnt+=ywrite_bytes_r(w,zeros,(size_t)(pad<32?pad:32));
+	return cnt+yp_write_uint_r(w,x,0);
+}
+
+/* %.Ns: at most prec bytes of s, stopping early at a NUL */
+static YP_COLD int yp_write_strn_r(ywriter *w,const char *s,int prec)
+{
+	const char *z=(const char*)memchr(s,0,(size_t)prec);
+	return ywrite_bytes_r(w,s,z?(size_t)(z-s):(size_t)prec);
+}
+
+/*
+ * Specifiers mirror yscanf(): %d %u %lld %llu %s %c %% and %f %e %g (with
+ * or without 'l'), which print the shortest round-trip form. A precision
+ * zero-pads integers to that many digits (%.3d), caps %s at that many
+ * bytes without reading past them (%.5s), and is handed to snprintf for
+ * floats (%.3f); %c and %% take none. Returns the bytes written (stored,
+ * for a memory writer that fills up), or -1 at an unsupported specifier.
+ */
+static inline int yvprintf_r(ywriter *w,const char *fmt,va_list ap)
+{
+	int cnt=0;
+
+	while(*fmt){
+		const char *lit=fmt;
+		int prec=-1;
+		while(*fmt&&*fmt!='%')fmt++;
+		if(fmt>lit)cnt+=ywrite_bytes_r(w,lit,(size_t)(fmt-lit));
+		if(!*fmt)break;
+		fmt++;
+
+		if(*fmt=='.'){
+			prec=0;
+			while(*++fmt>='0'&&*fmt<='9')prec=prec*10+(*fmt-'0');
+		}
+		if(*fmt=='d'||(*fmt=='l'&&fmt[1]=='l'&&fmt[2]=='d')){
+			long long v;
+			if(*fmt=='l'){v=va_arg(ap,long long);fmt+=2;}
+			else v=va_arg(ap,int);
+			if(prec<0)cnt+=ywrite_ll_r(w,v);
+			else cnt+=yp_write_prec_r(w,v<0?0-(unsigned long long)v:(unsigned long long)v,v<0,prec);
+		}
+		else if(*fmt=='u'||(*fmt=='l'&&fmt[1]=='l'&&fmt[2]=='u')){
+			unsigned long long v;
+			if(*fmt=='l'){v=va_arg(ap,unsigned long long);fmt+=2;}
+			else v=va_arg(ap,unsigned);
+			if(prec<0)cnt+=ywrite_ull_r(w,v);
+			else cnt+=yp_write_prec_r(w,v,0,prec);
+		}
+		else if(*fmt=='f'||*fmt=='e'||*fmt=='g'||
+			(*fmt=='l'&&(fmt[1]=='f'||fmt[1]=='e'||fmt[1]=='g'))){
+			double x=va_arg(ap,double);
+			fmt+=*fmt=='l';
+			if(prec<0)cnt+=ywrite_double_r(w,x);
+			else{
+				char spec[8]={'%','.','*',*fmt,0},t[512];
+				int n=snprintf(t,sizeof(t),spec,prec,x);
+				if(n<0)return -1;
+				if((size_t)n>=sizeof(t)){
+					/* %.Nf of a huge value */
+					char *big=(char*)malloc((size_t)n+1);
+					if(!big)return -1;
+					snprintf(big,(size_t)n+1,spec,prec,x);
+					cnt+=ywrite_bytes_r(w,big,(size_t)n);
+					free(big);
+				}
+				else cnt+=ywrite_bytes_r(w,t,(size_t)n);
+			}
+		}
+		else if(*fmt=='s'){
+			const char *str=va_arg(ap,const char*);
+			cnt+=prec<0?ywrite_str_r(w,str):yp_write_strn_r(w,str,prec);
+		}
+		else if(prec>=0){
+			return -1;
+		}
+		else if(*fmt=='c'){
+			cnt+=ywrite_char_r(w,(char)va_arg(ap,int));
+		}
+		else if(*fmt=='%'){
+			cnt+=ywrite_char_r(w,'%');
+		}
+		else{
+			return -1;
+		}
+		fmt++;
+	}
+
+	return cnt;
+}
+
+static inline int yprintf_r(ywriter *w,const char *fmt,...)
+{
+	va_list ap;
+	int ret;
+	va_start(ap,fmt);
+	ret=yvprintf_r(w,fmt,ap);
+	va_end(ap);
+	return ret;
+}
+
+static inline int yprintf(const char *fmt,...)
+{
+	va_list ap;
+	int ret;
+	va_start(ap,fmt);
+	ret=yvprintf_r(&ystd_writer,fmt,ap);
+	va_end(ap);
+	return ret;
+}
+
+/* ========================= DEFAULT WRITER ========================= */
+
+static inline int ywrite_int(int x){return ywrite_int_r(&ystd_writer,x);}
+static inline int ywrite_uint(unsigned x){return ywrite_uint_r(&ystd_writer,x);}
+static inline int ywrite_ll(long long x){return ywrite_ll_r(&ystd_writer,x);}
+static inline int ywrite_ull(unsigned long long x){return ywrite_ull_r(&ystd_writer,x);}
+static inline int ywrite_double(double x){return ywrite_double_r(&ystd_writer,x);}
+static inline int ywrite_char(char c){return ywrite_char_r(&ystd_writer,c);}
+static inline int ywrite_str(const char *s){return ywrite_str_r(&ystd_writer,s);}
+static inline void yflush(void){yflush_r(&ystd_writer);}
+
+#endif /* YPRINTF_H */
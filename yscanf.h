@@ -0,0 +1,3485 @@
+/**
+ * @file yscanf.h
+ * @brief High-performance buffered input parser
+ * @author Summer PLUS Studio
+ * @email yuzhouhunter@outlook.com
+ * @version 3.0
+ */
+
+#ifndef YSCANF_H
+#define YSCANF_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "yscanf_float.h"
+
+/* ========================= CONFIG ========================= */
+
+#ifndef YSCANF_BUFFER_SIZE
+#define YSCANF_BUFFER_SIZE (1 << 22)
+#endif
+
+/*
+ * Bytes readable past the end of every buffer the reader owns. The first
+ * is a NUL sentinel, so digit loops stop without a bounds check, and the
+ * rest let 16- and 64-byte loads run over the buffer end.
+ */
+#ifndef YSCANF_PAD
+#define YSCANF_PAD 64
+#endif
+
+/* overflow policy of the _ok readers and yscanf(); see YOVF_* */
+#ifndef YSCANF_OVERFLOW
+#define YSCANF_OVERFLOW YOVF_SATURATE
+#endif
+
+/* thread-local storage for the per-thread caches; left undefined if unavailable */
+#if defined(__cplusplus)&&__cplusplus>=201103L
+#define YTLS thread_local
+#elif defined(__STDC_VERSION__)&&__STDC_VERSION__>=201112L
+#define YTLS _Thread_local
+#elif defined(__GNUC__)||defined(__clang__)
+#define YTLS __thread
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define YLIKELY(x)   __builtin_expect(!!(x),1)
+#define YUNLIKELY(x) __builtin_expect(!!(x),0)
+#define YCOLD        __attribute__((noinline,cold,unused))
+#else
+#define YLIKELY(x)   (x)
+#define YUNLIKELY(x) (x)
+#define YCOLD
+#endif
+
+/* ========================= READER ========================= */
+
+/*
+ * All parser state lives in a yreader, so several inputs can be read at
+ * once (one reader per thread). The buffer is allocated on the first fread
+ * refill, so a reader served from a mapping or a memory span never carries
+ * one. yscanf() and the plain readers use a default reader bound to stdin.
+ */
+enum{YSRC_STDIN,YSRC_FILE,YSRC_FD,YSRC_MEM,YSRC_FN};
+
+/* a user source: fills up to cap bytes of buf, returns 0 at end of input */
+typedef size_t (*ysource_fn)(void *ctx,char *buf,size_t cap);
+
+/* buffer strategies for yreader_set_alloc() */
+enum{YBUF_MALLOC,YBUF_ALIGNED,YBUF_HUGE,YBUF_AUTO};
+enum{YBK_HEAP,YBK_MAP,YBK_USER,YBK_POOL};
+
+/*
+ * What an integer reader does with a value that does not fit its type:
+ * YOVF_SATURATE clamps it to the type's limits, YOVF_FAIL rejects the
+ * token (the reader returns 0; its digits are consumed) and YOVF_UNCHECKED
+ * drops the check and wraps like a cast. The _ovf_r readers take the
+ * policy per call site; with a constant the other branches fold away. The
+ * _ok readers and yscanf() use YSCANF_OVERFLOW, YOVF_SATURATE by default.
+ */
+enum{YOVF_SATURATE,YOVF_FAIL,YOVF_UNCHECKED};
+
+/*
+ * Counters filled in by YSCANF_STATS builds; they stay zero otherwise, so
+ * the struct is always present and yreader has one layout in every TU.
+ */
+typedef struct ystats{
+	unsigned long long refills;	/* reads or mappings of the source */
+	unsigned long long bytes;	/* bytes read or mapped */
+	unsigned long long read_ns;	/* time spent in fread/read/mmap */
+	unsigned long long ints,lls,doubles,strs,chars;
+	unsigned long long straddles;	/* tokens split across a refill */
+	unsigned long long ws_bytes;	/* whitespace skipped between tokens */
+}ystats;
+
+typedef struct yreader{
+	char *ptr,*end;
+	int eof;
+	int src;
+	FILE *fp;
+	int fd;
+	ysource_fn fn;	/* YSRC_FN source and its context */
+	void *ctx;
+	char *buf;
+	size_t cap;
+	size_t want;	/* requested buffer size, 0 for YSCANF_BUFFER_SIZE */
+	int buf_mode;	/* YBUF_* allocation strategy */
+	int buf_kind;	/* how buf is released */
+	int map_state;
+	char *map;
+	size_t maplen;
+	int pad;	/* *end is a NUL and YSCANF_PAD bytes from end are readable */
+	char *mark;	/* yreader_mark() position, kept across refills */
+	struct yprefetch *pf;
+	struct ydelim *dl;	/* delimited-field mode, see yreader_set_delim() */
+	struct yzsrc *z;	/* decompressing source, see yreader_decompress() */
+	ystats stats;
+}yreader;
+
+/* a token inside the reader's buffer; see yread_view_ok_r() */
+typedef struct ystr{
+	const char *ptr;
+	size_t len;
+}ystr;
+
+static yreader ystd_reader;
+
+static inline yreader *ystdin(void)
+{
+	return &ystd_reader;
+}
+
+/* ========================= STATS ========================= */
+
+#ifdef YSCANF_STATS
+#include <time.h>
+#define YSTAT(x) ((void)(x))
+
+static inline unsigned long long ystat_ns(void)
+{
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return (unsigned long long)ts.tv_sec*1000000000ULL+(unsigned long long)ts.tv_nsec;
+#else
+	return (unsigned long long)((double)clock()*(1e9/CLOCKS_PER_SEC));
+#endif
+}
+#else
+#define YSTAT(x) ((void)0)
+#endif
+
+/* ========================= MMAP ========================= */
+
+/*
+ * When the source is a regular file it is mapped once and ptr/end walk the
+ * mapping directly, skipping both the stdio and the buffer copy. Pipes, ttys
+ * and platforms without mmap keep the fread path. Define YSCANF_NO_MMAP to
+ * always use fread.
+ */
+/* strict ISO modes (-std=c11) hide the POSIX calls unless asked for */
+#if (defined(__unix__)||defined(__APPLE__))&&(!defined(__STRICT_ANSI__)|| \
+	(defined(_POSIX_C_SOURCE)&&_POSIX_C_SOURCE>=200112L)||defined(_XOPEN_SOURCE)||defined(_DEFAULT_SOURCE)||defined(_GNU_SOURCE))
+#define YSCANF_HAVE_POSIX 1
+#include <unistd.h>
+#include <sys/stat.h>
+#if !defined(YSCANF_NO_MMAP)
+#define YSCANF_HAVE_MMAP 1
+#include <sys/mman.h>
+#endif
+#endif
+
+#ifdef YSCANF_HAVE_POSIX
+/* the descriptor behind the source, -1 for memory and callbacks */
+static inline int ysrc_fd_r(yreader *r)
+{
+	if(r->src==YSRC_MEM||r->src==YSRC_FN)return -1;
+	return r->src==YSRC_FD?r->fd:fileno(r->src==YSRC_FILE?r->fp:stdin);
+}
+#endif
+
+#ifdef YSCANF_HAVE_MMAP
+/* map_state: 0 not tried yet, 1 mapped, -1 not mappable */
+static YCOLD int ymap_r(yreader *r)
+{
+	struct stat st;
+	long long off;
+	void *p;
+	int fd=ysrc_fd_r(r);
+	r->map_state=-1;
+	if(fd<0||fstat(fd,&st)||!S_ISREG(st.st_mode)||st.st_size<=0)return 0;
+	if((unsigned long long)st.st_size>(size_t)-1)return 0;
+	if(r->src==YSRC_FD)off=lseek(fd,0,SEEK_CUR);
+	else off=ftell(r->src==YSRC_FILE?r->fp:stdin);
+	if(off<0||off>=st.st_size)return 0;
+#ifdef YSCANF_STATS
+	r->stats.read_ns-=ystat_ns();
+#endif
+	p=mmap(NULL,(size_t)st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+	if(p==MAP_FAILED)return 0;
+	posix_madvise(p,(size_t)st.st_size,POSIX_MADV_SEQUENTIAL);
+#ifdef YSCANF_STATS
+	r->stats.read_ns+=ystat_ns();
+	r->stats.refills++;
+	r->stats.bytes+=(unsigned long long)(st.st_size-off);
+#endif
+	r->map=(char*)p;
+	r->maplen=(size_t)st.st_size;
+	r->ptr=r->map+off;
+	r->end=r->map+r->maplen;
+	r->map_state=1;
+	/* the rest of the last page reads as zeros */
+	{
+		size_t pg=(size_t)sysconf(_SC_PAGESIZE),tail=r->maplen&(pg-1);
+		r->pad=tail&&pg-tail>=YSCANF_PAD;
+	}
+	return 1;
+}
+#endif
+
+/* ========================= SOURCE ========================= */
+
+/* one read from the reader's FILE*, fd or callback into buf; 0 on EOF or error */
+static inline size_t ysrc_raw_r(yreader *r,char *buf,size_t cap)
+{
+	size_t n;
+#ifdef YSCANF_STATS
+	unsigned long long t0=ystat_ns();
+#endif
+#ifdef YSCANF_HAVE_POSIX
+	if(r->src==YSRC_FD){
+		ssize_t k;
+		while((k=read(r->fd,buf,cap))<0&&errno==EINTR);
+		n=k>0?(size_t)k:0;
+	}
+	else
+#endif
+	if(r->src==YSRC_FN)n=r->fn(r->ctx,buf,cap);
+	else n=fread(buf,1,cap,r->src==YSRC_FILE?r->fp:stdin);
+#ifdef YSCANF_STATS
+	r->stats.read_ns+=ystat_ns()-t0;
+	r->stats.refills+=n>0;
+	r->stats.bytes+=n;
+#endif
+	return n;
+}
+
+/* ========================= DECOMPRESSION ========================= */
+
+/*
+ * yreader_decompress() sniffs the magic bytes of a FILE*, fd or callback
+ * source and, for gzip (YSCANF_ZLIB, -lz), zstd (YSCANF_ZSTD, -lzstd) or
+ * lz4 frames (YSCANF_LZ4, -llz4), decodes straight into the reader's buffer
+ * on each refill. Concatenated members and frames are read through. Call
+ * it before the first read; yreader_prefetch() after it moves the decoding
+ * to the producer thread. Plain input is put back (or, if the source
+ * cannot seek, replayed) and reads as usual. Returns the YZ_* format found,
+ * or -1 if the source is unsuitable or its format was not compiled in; in
+ * the latter case the compressed bytes are read as they are.
+ */
+#ifdef YSCANF_ZLIB
+#include <zlib.h>
+#endif
+#ifdef YSCANF_ZSTD
+#include <zstd.h>
+#endif
+#ifdef YSCANF_LZ4
+#include <lz4frame.h>
+#endif
+
+enum{YZ_NONE,YZ_GZIP,YZ_ZSTD,YZ_LZ4};
+
+#ifndef YSCANF_ZIN_SIZE
+#define YSCANF_ZIN_SIZE ((size_t)128<<10)
+#endif
+
+typedef struct yzsrc{
+	int fmt;	/* YZ_*; YZ_NONE replays in[pos..len) before raw reads */
+	int done;	/* decoder error: the input ends here */
+	unsigned char *in;	/* compressed window */
+	size_t cap,pos,len;
+#ifdef YSCANF_ZLIB
+	z_stream zs;
+#endif
+#ifdef YSCANF_ZSTD
+	ZSTD_DCtx *zd;
+#endif
+#ifdef YSCANF_LZ4
+	LZ4F_dctx *lz;
+#endif
+}yzsrc;
+
+static inline void yz_free(yzsrc *z)
+{
+#ifdef YSCANF_ZLIB
+	if(z->fmt==YZ_GZIP)inflateEnd(&z->zs);
+#endif
+#ifdef YSCANF_ZSTD
+	if(z->fmt==YZ_ZSTD)ZSTD_freeDCtx(z->zd);
+#endif
+#ifdef YSCANF_LZ4
+	if(z->fmt==YZ_LZ4)LZ4F_freeDecompressionContext(z->lz);
+#endif
+	free(z->in);
+	free(z);
+}
+
+/* one decoder call on in[pos..len) into buf[*n..cap) */
+static inline void yz_step(yzsrc *z,char *buf,size_t cap,size_t *n)
+{
+	switch(z->fmt){
+#ifdef YSCANF_ZLIB
+	case YZ_GZIP:{
+		int e;
+		z->zs.next_in=z->in+z->pos;
+		z->zs.avail_in=(uInt)(z->len-z->pos);
+		z->zs.next_out=(Bytef*)buf+*n;
+		z->zs.avail_out=(uInt)(cap-*n);
+		e=inflate(&z->zs,Z_NO_FLUSH);
+		z->pos=z->len-z->zs.avail_in;
+		*n=cap-z->zs.avail_out;
+		/* Z_BUF_ERROR only asks for more input */
+		if(e==Z_STREAM_END)inflateReset(&z->zs);
+		else if(e!=Z_OK&&e!=Z_BUF_ERROR)z->done=1;
+		break;
+	}
+#endif
+#ifdef YSCANF_ZSTD
+	case YZ_ZSTD:{
+		ZSTD_inBuffer zi;
+		ZSTD_outBuffer zo;
+		zi.src=z->in;zi.size=z->len;zi.pos=z->pos;
+		zo.dst=buf;zo.size=cap;zo.pos=*n;
+		if(ZSTD_isError(ZSTD_decompressStream(z->zd,&zo,&zi)))z->done=1;
+		z->pos=zi.pos;
+		*n=zo.pos;
+		break;
+	}
+#endif
+#ifdef YSCANF_LZ4
+	case YZ_LZ4:{
+		size_t dn=cap-*n,sn=z->len-z->pos;
+		if(LZ4F_isError(LZ4F_decompress(z->lz,buf+*n,&dn,z->in+z->pos,&sn,NULL)))z->done=1;
+		z->pos+=sn;
+		*n+=dn;
+		break;
+	}
+#endif
+	default:
+		(void)buf;(void)cap;(void)n;
+		z->done=1;
+	}
+}
+
+static YCOLD size_t yz_read_r(yreader *r,char *buf,size_t cap)
+{
+	yzsrc *z=r->z;
+	size_t n=0;
+	if(z->fmt==YZ_NONE){
+		if(z->pos==z->len)return ysrc_raw_r(r,buf,cap);
+		n=z->len-z->pos<cap?z->len-z->pos:cap;
+		memcpy(buf,z->in+z->pos,n);
+		z->pos+=n;
+		return n;
+	}
+	if(cap>((size_t)1<<30))cap=(size_t)1<<30;
+	/* the decoder may still hold output, so it runs before any new input */
+	while(!z->done){
+		yz_step(z,buf,cap,&n);
+		if(n==cap)break;
+		if(z->pos==z->len){
+			/* do not block on the source with output in hand */
+			if(n)break;
+			z->pos=0;
+			if(!(z->len=ysrc_raw_r(r,(char*)z->in,z->cap)))break;
+		}
+	}
+	return n;
+}
+
+/* the next chunk of input: decoded if a decompressor is attached */
+static inline size_t ysrc_read_r(yreader *r,char *buf,size_t cap)
+{
+	return YUNLIKELY(r->z!=NULL)?yz_read_r(r,buf,cap):ysrc_raw_r(r,buf,cap);
+}
+
+/* puts k sniffed bytes back when the source can seek */
+static inline int yz_rewind_r(yreader *r,size_t k)
+{
+	if(r->src==YSRC_FN)return 0;
+#ifdef YSCANF_HAVE_POSIX
+	if(r->src==YSRC_FD)return lseek(r->fd,-(off_t)k,SEEK_CUR)>=0;
+#endif
+	return !fseek(r->src==YSRC_FILE?r->fp:stdin,-(long)k,SEEK_CUR);
+}
+
+static inline int yreader_decompress(yreader *r)
+{
+	yzsrc *z;
+	const unsigned char *m;
+	int fmt=YZ_NONE,ok=1;
+	if(r->src==YSRC_MEM||r->z||r->pf||r->ptr!=r->end||r->eof)return -1;
+	if(!(z=(yzsrc*)calloc(1,sizeof(*z))))return -1;
+	z->cap=YSCANF_ZIN_SIZE;
+	if(!(z->in=(unsigned char*)malloc(z->cap))){free(z);return -1;}
+	/* pipes and callbacks may return short counts */
+	while(z->len<4){
+		size_t k=ysrc_raw_r(r,(char*)z->in+z->len,4-z->len);
+		if(!k)break;
+		z->len+=k;
+	}
+	m=z->in;
+	if(z->len>=2&&m[0]==0x1f&&m[1]==0x8b)fmt=YZ_GZIP;
+	else if(z->len==4&&m[0]==0x28&&m[1]==0xb5&&m[2]==0x2f&&m[3]==0xfd)fmt=YZ_ZSTD;
+	else if(z->len==4&&m[0]==0x04&&m[1]==0x22&&m[2]==0x4d&&m[3]==0x18)fmt=YZ_LZ4;
+	if(fmt==YZ_NONE&&yz_rewind_r(r,z->len)){
+		yz_free(z);
+		return YZ_NONE;
+	}
+	switch(fmt){
+	case YZ_NONE:break;
+#ifdef YSCANF_ZLIB
+	case YZ_GZIP:ok=inflateInit2(&z->zs,15+32)==Z_OK;break;
+#endif
+#ifdef YSCANF_ZSTD
+	case YZ_ZSTD:ok=(z->zd=ZSTD_createDCtx())!=NULL;break;
+#endif
+#ifdef YSCANF_LZ4
+	case YZ_LZ4:ok=!LZ4F_isError(LZ4F_createDecompressionContext(&z->lz,LZ4F_VERSION));break;
+#endif
+	default:ok=0;
+	}
+	z->fmt=ok?fmt:YZ_NONE;
+	r->z=z;
+	r->map_state=-1;
+	return ok?fmt:-1;
+}
+
+/* ========================= PREFETCH ========================= */
+
+/*
+ * Opt-in (YSCANF_PREFETCH, link with -pthread): yreader_prefetch() starts a
+ * producer thread that fills one of two buffers while the parser drains the
+ * other, so refills stop waiting on I/O. Each slot is handed over with a
+ * single release/acquire flag, no locks. Meant for pipes and network
+ * filesystems; a prefetching reader never maps its input. Callback sources
+ * are not prefetched: the producer is cancelled on close, which user code
+ * need not be safe against.
+ */
+#if defined(YSCANF_PREFETCH)&&defined(YSCANF_HAVE_POSIX)
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+typedef struct yprefetch{
+	yreader *r;
+	pthread_t thr;
+	char *buf[2];
+	size_t len[2];
+	size_t cap;
+	int full[2];	/* 1: filled by the producer, owned by the parser */
+	int cur;	/* slot the parser is on, -1 before the first refill */
+	int stop;
+}yprefetch;
+
+/* spin briefly, then yield, then sleep: waits are rare and may be long */
+static inline void ypf_wait(unsigned *spins)
+{
+	if(++*spins<64)return;
+	if(*spins<256){sched_yield();return;}
+	{
+		struct timespec ts={0,20000};
+		nanosleep(&ts,NULL);
+	}
+}
+
+static void *ypf_main(void *arg)
+{
+	yprefetch *pf=(yprefetch*)arg;
+	int i=0;
+	for(;;){
+		unsigned spins=0;
+		while(__atomic_load_n(&pf->full[i],__ATOMIC_ACQUIRE)){
+			if(__atomic_load_n(&pf->stop,__ATOMIC_RELAXED))return NULL;
+			ypf_wait(&spins);
+		}
+		if(__atomic_load_n(&pf->stop,__ATOMIC_RELAXED))return NULL;
+		pf->len[i]=ysrc_read_r(pf->r,pf->buf[i],pf->cap);
+		pf->buf[i][pf->len[i]]=0;
+		__atomic_store_n(&pf->full[i],1,__ATOMIC_RELEASE);
+		if(!pf->len[i])return NULL;
+		i^=1;
+	}
+}
+
+/* hands the drained slot back and switches to the other one */
+static YCOLD int ypf_next_r(yreader *r)
+{
+	yprefetch *pf=r->pf;
+	unsigned spins=0;
+	int i;
+	if(pf->cur>=0)__atomic_store_n(&pf->full[pf->cur],0,__ATOMIC_RELEASE);
+	i=pf->cur=(pf->cur+1)&1;
+	while(!__atomic_load_n(&pf->full[i],__ATOMIC_ACQUIRE))ypf_wait(&spins);
+	if(!pf->len[i]){r->eof=1;return 0;}
+	r->ptr=pf->buf[i];
+	r->end=pf->buf[i]+pf->len[i];
+	r->pad=1;
+	return 1;
+}
+
+/* call before the first read; returns 0 (and stays synchronous) on failure */
+static inline int yreader_prefetch(yreader *r)
+{
+	yprefetch *pf;
+	if(r->src==YSRC_MEM||r->src==YSRC_FN||r->pf||r->ptr!=r->end)return 0;
+	if(!(pf=(yprefetch*)calloc(1,sizeof(*pf))))return 0;
+	pf->r=r;
+	pf->cap=r->want?r->want:YSCANF_BUFFER_SIZE;
+	pf->cur=-1;
+	pf->buf[0]=(char*)calloc(2,pf->cap+YSCANF_PAD);
+	pf->buf[1]=pf->buf[0]+pf->cap+YSCANF_PAD;
+	if(!pf->buf[0]||pthread_create(&pf->thr,NULL,ypf_main,pf)){
+		free(pf->buf[0]);
+		free(pf);
+		return 0;
+	}
+	r->pf=pf;
+	r->map_state=-1;
+	return 1;
+}
+
+static inline void ypf_stop(yprefetch *pf)
+{
+	__atomic_store_n(&pf->stop,1,__ATOMIC_RELAXED);
+	/* the producer may be blocked in read(2) on a pipe */
+	pthread_cancel(pf->thr);
+	pthread_join(pf->thr,NULL);
+	free(pf->buf[0]);
+	free(pf);
+}
+#else
+static inline int yreader_prefetch(yreader *r){(void)r;return 0;}
+#endif
+
+/* ========================= BUFFER ========================= */
+
+/*
+ * The fread/read buffer is sized and allocated per reader on its first
+ * refill. yreader_set_alloc() picks the strategy and size, and
+ * yreader_set_buffer() lends a caller buffer instead; both must come
+ * before the first read. YBUF_ALIGNED is 64-byte aligned for vector
+ * loads, YBUF_HUGE asks for 2 MiB pages (falling back to normal pages),
+ * YBUF_AUTO sizes from fstat: the whole remaining file for regular files,
+ * 256 KiB for pipes, capped by the requested size (64 MiB if none).
+ * Owned buffers carry YSCANF_PAD bytes beyond cap; borrowed ones do not.
+ */
+#ifndef YSCANF_AUTO_MAX
+#define YSCANF_AUTO_MAX ((size_t)64<<20)
+#endif
+
+static inline int yreader_set_alloc(yreader *r,int mode,size_t cap)
+{
+	if(r->buf||r->end||r->eof||mode<YBUF_MALLOC||mode>YBUF_AUTO)return 0;
+	r->buf_mode=mode;
+	r->want=cap;
+	return 1;
+}
+
+/* the buffer is borrowed; it is only replaced if one token outgrows it */
+static inline int yreader_set_buffer(yreader *r,void *buf,size_t cap)
+{
+	if(r->buf||r->end||r->eof||!buf||!cap)return 0;
+	r->buf=(char*)buf;
+	r->cap=r->want=cap;
+	r->buf_kind=YBK_USER;
+	return 1;
+}
+
+static inline void ybuf_release_r(yreader *r)
+{
+#ifdef YSCANF_HAVE_MMAP
+	if(r->buf_kind==YBK_MAP){munmap(r->buf,r->cap+YSCANF_PAD);return;}
+#endif
+	if(r->buf_kind==YBK_HEAP)free(r->buf);
+}
+
+static inline size_t yauto_size_r(yreader *r)
+{
+	size_t max=r->want?r->want:YSCANF_AUTO_MAX;
+#ifdef YSCANF_HAVE_POSIX
+	struct stat st;
+	int fd=ysrc_fd_r(r);
+	if(fd>=0&&!fstat(fd,&st)){
+		if(S_ISREG(st.st_mode)){
+			/* one byte spare so the read after the last one sees EOF */
+			unsigned long long n=(unsigned long long)st.st_size+1;
+			if(n<4096)n=4096;
+			return n<max?(size_t)n:max;
+		}
+		return max<((size_t)256<<10)?max:(size_t)256<<10;
+	}
+#endif
+	return max<(size_t)YSCANF_BUFFER_SIZE?max:(size_t)YSCANF_BUFFER_SIZE;
+}
+
+static YCOLD int ybuf_alloc_r(yreader *r)
+{
+	size_t cap=r->want?r->want:YSCANF_BUFFER_SIZE;
+	void *p=NULL;
+	if(r->buf_mode==YBUF_AUTO)cap=yauto_size_r(r);
+	r->buf_kind=YBK_HEAP;
+#if defined(YSCANF_HAVE_MMAP)&&defined(MAP_ANONYMOUS)
+	if(r->buf_mode==YBUF_HUGE){
+		size_t huge=(size_t)2<<20,len=(cap+YSCANF_PAD+huge-1)&~(huge-1);
+#ifdef MAP_HUGETLB
+		p=mmap(NULL,len,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB,-1,0);
+		if(p==MAP_FAILED)p=NULL;
+#endif
+		if(!p){
+			/* no reserved huge pages: let transparent huge pages back it */
+			p=mmap(NULL,len,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+			if(p==MAP_FAILED)p=NULL;
+#ifdef MADV_HUGEPAGE
+			else madvise(p,len,MADV_HUGEPAGE);
+#endif
+		}
+		if(p){r->buf_kind=YBK_MAP;cap=len-YSCANF_PAD;}
+	}
+#endif
+#ifdef YSCANF_HAVE_POSIX
+	if(!p&&(r->buf_mode==YBUF_ALIGNED||r->buf_mode==YBUF_HUGE)&&posix_memalign(&p,64,cap+YSCANF_PAD))p=NULL;
+#endif
+	if(!p&&!(p=malloc(cap+YSCANF_PAD)))return 0;
+	r->buf=(char*)p;
+	r->cap=cap;
+	memset(r->buf+cap,0,YSCANF_PAD);
+	return 1;
+}
+
+/* moves the buffer to a heap block of cap bytes, keeping the first keep */
+static YCOLD int ybuf_grow_r(yreader *r,size_t cap,size_t keep)
+{
+	char *nb;
+	if(r->buf_kind==YBK_HEAP){
+		if(!(nb=(char*)realloc(r->buf,cap+YSCANF_PAD)))return 0;
+	}
+	else{
+		if(!(nb=(char*)malloc(cap+YSCANF_PAD)))return 0;
+		memcpy(nb,r->buf,keep);
+		ybuf_release_r(r);
+		r->buf_kind=YBK_HEAP;
+	}
+	r->buf=nb;
+	r->cap=cap;
+	memset(r->buf+cap,0,YSCANF_PAD);
+	return 1;
+}
+
+/* after a read into buf: plants the sentinel if the buffer is padded */
+static inline void ybuf_seal_r(yreader *r)
+{
+	r->pad=r->buf_kind!=YBK_USER;
+	if(r->pad)*r->end=0;
+}
+
+/* ========================= SETUP ========================= */
+
+/* resolves the scan kernels once, before any thread scans (KERNEL DISPATCH) */
+static inline void ykernel_init(void);
+
+static inline void yreader_init_file(yreader *r,FILE *fp)
+{
+	memset(r,0,sizeof(*r));
+	r->src=YSRC_FILE;
+	r->fp=fp;
+	ykernel_init();
+}
+
+#ifdef YSCANF_HAVE_POSIX
+static inline void yreader_init_fd(yreader *r,int fd)
+{
+	memset(r,0,sizeof(*r));
+	r->src=YSRC_FD;
+	r->fd=fd;
+	ykernel_init();
+}
+#endif
+
+/* the span is borrowed and must outlive the reader */
+static inline void yreader_init_mem(yreader *r,const void *data,size_t len)
+{
+	memset(r,0,sizeof(*r));
+	r->src=YSRC_MEM;
+	r->ptr=(char*)data;
+	r->end=r->ptr+len;
+	ykernel_init();
+}
+
+/*
+ * Pulls input from fn(ctx,buf,cap), e.g. a socket, a decompressor or a
+ * ring buffer. Tokens may straddle calls; a short count is not EOF, 0 is.
+ */
+static inline void yreader_init_fn(yreader *r,ysource_fn fn,void *ctx)
+{
+	memset(r,0,sizeof(*r));
+	r->src=YSRC_FN;
+	r->fn=fn;
+	r->ctx=ctx;
+	r->map_state=-1;
+	ykernel_init();
+}
+
+static void ydelim_free(struct ydelim *d);
+
+/* releases the buffer and mapping; the FILE*, fd or callback context is left open */
+static inline void yreader_close(yreader *r)
+{
+	if(r->dl)ydelim_free(r->dl);
+#if defined(YSCANF_PREFETCH)&&defined(YSCANF_HAVE_POSIX)
+	if(r->pf)ypf_stop(r->pf);
+#endif
+	if(r->z)yz_free(r->z);
+#ifdef YSCANF_HAVE_MMAP
+	if(r->map)munmap(r->map,r->maplen);
+#endif
+	ybuf_release_r(r);
+	memset(r,0,sizeof(*r));
+}
+
+/* ========================= CHARACTER CLASSES ========================= */
+
+/*
+ * One table drives all byte classification, so every test is a single
+ * load and setlocale() cannot change what the parser accepts. Whitespace
+ * is the C-locale set: ' ' and '\t'..'\r', and blanks are whitespace other
+ * than '\n'. YC_DELIM marks the usual field separators , ; | and tab.
+ * Bytes 128-255 belong to no class.
+ */
+enum{YC_SPACE=1,YC_BLANK=2,YC_DIGIT=4,YC_SIGN=8,YC_EXP=16,YC_DELIM=32};
+
+static const unsigned char yctype[256]={
+	0,0,0,0,0,0,0,0,0,35,1,3,3,3,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	3,0,0,0,0,0,0,0,0,0,0,8,32,8,0,0,
+	4,4,4,4,4,4,4,4,4,4,0,32,0,0,0,0,
+	0,0,0,0,0,16,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,16,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,32,0,0,0,
+};
+
+static inline int yisspace(int c){return yctype[(unsigned char)c]&YC_SPACE;}
+static inline int yisblank(int c){return yctype[(unsigned char)c]&YC_BLANK;}
+/* c may be EOF */
+static inline int yisdigit(int c){return c!=EOF&&(yctype[(unsigned char)c]&YC_DIGIT);}
+
+/* ========================= SCAN KERNELS ========================= */
+
+/*
+ * The span kernels classify a whole block of whitespace per step (AVX2 32
+ * bytes, SSE2/NEON 16, SWAR 8) with the same set as yisspace(), and only
+ * run the table on the tail of the buffered range. Define YSCANF_NO_SIMD
+ * to keep the byte loop only. With YSCANF_DISPATCH every variant the
+ * target has is built and one is picked at run time; see KERNEL DISPATCH.
+ */
+
+#if !defined(YSCANF_NO_SIMD)&&(defined(__GNUC__)||defined(__clang__))
+#if defined(YSCANF_DISPATCH)
+#define YSCAN_DISPATCH 1
+#if defined(__x86_64__)||defined(__i386__)
+#define YSCAN_X86 1
+#endif
+#endif
+#if defined(YSCAN_X86)
+#define YTARGET(t) __attribute__((target(t)))
+#else
+#define YTARGET(t)
+#endif
+
+#if defined(__AVX2__)||defined(YSCAN_X86)
+#include <immintrin.h>
+/* index of the first byte that is (want_space ? space : non-space) */
+static inline YTARGET("avx2") unsigned yscan_avx2(const char *p,int want_space)
+{
+	__m256i v=_mm256_loadu_si256((const __m256i*)p);
+	__m256i t=_mm256_sub_epi8(v,_mm256_set1_epi8('\t'));
+	__m256i m=_mm256_or_si256(_mm256_cmpeq_epi8(v,_mm256_set1_epi8(' ')),
+		_mm256_cmpeq_epi8(_mm256_min_epu8(t,_mm256_set1_epi8(4)),t));
+	unsigned bits=(unsigned)_mm256_movemask_epi8(m);
+	if(!want_space)bits=~bits;
+	return bits?(unsigned)__builtin_ctz(bits):32;
+}
+#endif
+#if defined(YSCAN_X86)
+static inline YTARGET("avx512bw") unsigned yscan_avx512(const char *p,int want_space)
+{
+	__m512i v=_mm512_loadu_si512((const void*)p);
+	__m512i t=_mm512_sub_epi8(v,_mm512_set1_epi8('\t'));
+	unsigned long long bits=_mm512_cmpeq_epi8_mask(v,_mm512_set1_epi8(' '))|
+		_mm512_cmple_epu8_mask(t,_mm512_set1_epi8(4));
+	if(!want_space)bits=~bits;
+	return bits?(unsigned)__builtin_ctzll(bits):64;
+}
+#endif
+#if defined(__SSE2__)||defined(YSCAN_X86)
+#include <emmintrin.h>
+static inline YTARGET("sse2") unsigned yscan_sse2(const char *p,int want_space)
+{
+	__m128i v=_mm_loadu_si128((const __m128i*)p);
+	__m128i t=_mm_sub_epi8(v,_mm_set1_epi8('\t'));
+	__m128i m=_mm_or_si128(_mm_cmpeq_epi8(v,_mm_set1_epi8(' ')),
+		_mm_cmpeq_epi8(_mm_min_epu8(t,_mm_set1_epi8(4)),t));
+	unsigned bits=(unsigned)_mm_movemask_epi8(m);
+	if(!want_space)bits=~bits&0xffffu;
+	return bits?(unsigned)__builtin_ctz(bits):16;
+}
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+static inline unsigned yscan_neon(const char *p,int want_space)
+{
+	uint8x16_t v=vld1q_u8((const uint8_t*)p);
+	uint8x16_t m=vorrq_u8(vceqq_u8(v,vdupq_n_u8(' ')),
+		vcleq_u8(vsubq_u8(v,vdupq_n_u8('\t')),vdupq_n_u8(4)));
+	/* narrow to 4 bits per byte */
+	uint64_t bits=vget_lane_u64(vreinterpret_u64_u8(
+		vshrn_n_u16(vreinterpretq_u16_u8(m),4)),0);
+	if(!want_space)bits=~bits;
+	return bits?(unsigned)__builtin_ctzll(bits)>>2:16;
+}
+#endif
+#if defined(__BYTE_ORDER__)&&__BYTE_ORDER__==__ORDER_LITTLE_ENDIAN__
+#define YSCAN_SWAR 1
+#define YSWAR_L(b) (0x0101010101010101ULL*(unsigned char)(b))
+#define YSWAR_H    0x8080808080808080ULL
+static inline unsigned yscan_swar(const char *p,int want_space)
+{
+	unsigned long long x,t,eq,ge9,ge14,bits;
+	memcpy(&x,p,8);
+	/* exact per-byte tests, bit 7 of each byte carries the result */
+	t=x^YSWAR_L(' ');
+	eq=~(((t&~YSWAR_H)+~YSWAR_H)|t)&YSWAR_H;
+	ge9=((x|YSWAR_H)-YSWAR_L('\t'))&YSWAR_H;
+	ge14=((x|YSWAR_H)-YSWAR_L('\r'+1))&YSWAR_H;
+	bits=eq|(ge9&~ge14&~x);
+	if(!want_space)bits=~bits&YSWAR_H;
+	return bits?(unsigned)__builtin_ctzll(bits)>>3:8;
+}
+#endif
+
+#if defined(YSCAN_DISPATCH)
+#elif defined(__AVX2__)
+#define YSCAN_BLOCK 32
+#define yscan_block yscan_avx2
+#elif defined(__SSE2__)
+#define YSCAN_BLOCK 16
+#define yscan_block yscan_sse2
+#elif defined(__ARM_NEON)
+#define YSCAN_BLOCK 16
+#define yscan_block yscan_neon
+#elif defined(YSCAN_SWAR)
+#define YSCAN_BLOCK 8
+#define yscan_block yscan_swar
+#endif
+#endif
+
+#ifndef YSCAN_DISPATCH
+/* first non-space byte in [p,e), or e */
+static inline char *yskip_ws_span(char *p,char *e)
+{
+#ifdef YSCAN_BLOCK
+	while(e-p>=YSCAN_BLOCK){
+		unsigned i=yscan_block(p,0);
+		if(i<YSCAN_BLOCK)return p+i;
+		p+=YSCAN_BLOCK;
+	}
+#endif
+	while(p<e&&yisspace((unsigned char)*p))p++;
+	return p;
+}
+
+/* first space byte in [p,e), or e */
+static inline char *yfind_ws_span(char *p,char *e)
+{
+#ifdef YSCAN_BLOCK
+	while(e-p>=YSCAN_BLOCK){
+		unsigned i=yscan_block(p,1);
+		if(i<YSCAN_BLOCK)return p+i;
+		p+=YSCAN_BLOCK;
+	}
+#endif
+	while(p<e&&!yisspace((unsigned char)*p))p++;
+	return p;
+}
+#endif
+
+/* ========================= SCANSETS ========================= */
+
+/*
+ * A %[...] scanset compiles to a 256-bit membership bitmap plus two
+ * 16-byte nibble tables: lo[n] and hi[n] hold, for low nibble n, one bit
+ * per high nibble 0-7 and 8-15. yset_block() classifies a whole block
+ * with two byte shuffles (pshufb/tbl) and a bit test; everything else
+ * uses the bitmap. Plain SSE2 has no byte shuffle, so yset_stops() also
+ * lists the runs of bytes that end a span ([^,] has one, a CSV reader's
+ * separator, quote, \r and \n at most four) and yset_runs_sse2() tests
+ * each block against them with a range compare per run. A set with more
+ * than YSET_STOPS such runs (nstop 0) is spanned a byte at a time there.
+ */
+#define YSET_STOPS 4
+
+typedef struct yset{
+	unsigned char bits[32];
+	unsigned char lo[16],hi[16];
+	unsigned char stop[YSET_STOPS],slen[YSET_STOPS];	/* first byte and length-1 of each run */
+	unsigned char nstop;
+}yset;
+
+static inline void yset_add(yset *set,unsigned c)
+{
+	set->bits[c>>3]|=(unsigned char)(1u<<(c&7));
+	if(c<128)set->lo[c&15]|=(unsigned char)(1u<<(c>>4));
+	else set->hi[c&15]|=(unsigned char)(1u<<((c>>4)-8));
+}
+
+static inline int yset_has(const yset *set,int c)
+{
+	return set->bits[(unsigned char)c>>3]>>((unsigned char)c&7)&1;
+}
+
+/* fills stop[]/slen[] from the bitmap once the set is complete; unused slots repeat the first run */
+static inline void yset_stops(yset *set)
+{
+	unsigned c=0,a,n=0;
+	set->nstop=0;
+	while(c<256){
+		if(yset_has(set,(int)c)){c++;continue;}
+		if(n==YSET_STOPS)return;
+		a=c;
+		while(c<256&&!yset_has(set,(int)c))c++;
+		set->stop[n]=(unsigned char)a;
+		set->slen[n]=(unsigned char)(c-1-a);
+		n++;
+	}
+	for(c=n;n&&c<YSET_STOPS;c++){
+		set->stop[c]=set->stop[0];
+		set->slen[c]=set->slen[0];
+	}
+	set->nstop=(unsigned char)n;
+}
+
+/*
+ * Compiles the scanset at fmt ("[a-z_]", "[^,]", "[]x]"): a leading ^
+ * negates, a ] right after [ or [^ is a member and a-z is a range unless
+ * the - is first or last. Returns the closing ], or NULL if there is none.
+ */
+static inline const char *yset_compile(yset *set,const char *fmt)
+{
+	const unsigned char *f=(const unsigned char*)fmt+1;
+	unsigned char mem[32];
+	int neg=0;
+	unsigned c,i;
+	memset(mem,0,sizeof(mem));
+	if(*f=='^'){neg=1;f++;}
+	if(*f==']'){mem[']'>>3]|=1u<<(']'&7);f++;}
+	for(;*f&&*f!=']';f++){
+		c=*f;
+		if(f[1]=='-'&&f[2]&&f[2]!=']'&&f[2]>=c){
+			for(;c<=f[2];c++)mem[c>>3]|=(unsigned char)(1u<<(c&7));
+			f+=2;
+		}
+		else mem[c>>3]|=(unsigned char)(1u<<(c&7));
+	}
+	if(!*f)return NULL;
+	memset(set,0,sizeof(*set));
+	for(i=0;i<256;i++)
+		if((mem[i>>3]>>(i&7)&1)!=neg)yset_add(set,i);
+	yset_stops(set);
+	return (const char*)f;
+}
+
+#if !defined(YSCANF_NO_SIMD)&&(defined(__GNUC__)||defined(__clang__))
+#if defined(__AVX2__)||defined(YSCAN_X86)
+/* index of the first byte not in set */
+static inline YTARGET("avx2") unsigned yset_avx2(const yset *set,const char *p)
+{
+	const __m256i nib=_mm256_set1_epi8(0x0f);
+	__m256i v=_mm256_loadu_si256((const __m256i*)p);
+	__m256i lo=_mm256_and_si256(v,nib);
+	__m256i hi=_mm256_and_si256(_mm256_srli_epi16(v,4),nib);
+	__m256i rl=_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)set->lo)),lo);
+	__m256i rh=_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)set->hi)),lo);
+	__m256i row=_mm256_blendv_epi8(rh,rl,_mm256_cmpgt_epi8(_mm256_set1_epi8(8),hi));
+	__m256i bit=_mm256_shuffle_epi8(_mm256_setr_epi8(1,2,4,8,16,32,64,-128,1,2,4,8,16,32,64,-128,
+		1,2,4,8,16,32,64,-128,1,2,4,8,16,32,64,-128),hi);
+	unsigned bits=~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row,bit),bit));
+	return bits?(unsigned)__builtin_ctz(bits):32;
+}
+#endif
+#if defined(YSCAN_X86)
+static inline YTARGET("avx512bw") unsigned yset_avx512(const yset *set,const char *p)
+{
+	const __m512i nib=_mm512_set1_epi8(0x0f);
+	__m512i v=_mm512_loadu_si512((const void*)p);
+	__m512i lo=_mm512_and_si512(v,nib);
+	__m512i hi=_mm512_and_si512(_mm512_srli_epi16(v,4),nib);
+	__m512i rl=_mm512_shuffle_epi8(_mm512_maskz_broadcast_i32x4(0xffff,_mm_loadu_si128((const __m128i*)set->lo)),lo);
+	__m512i rh=_mm512_shuffle_epi8(_mm512_maskz_broadcast_i32x4(0xffff,_mm_loadu_si128((const __m128i*)set->hi)),lo);
+	__m512i row=_mm512_mask_blend_epi8(_mm512_cmplt_epu8_mask(hi,_mm512_set1_epi8(8)),rh,rl);
+	__m512i bit=_mm512_shuffle_epi8(_mm512_maskz_broadcast_i32x4(0xffff,
+		_mm_setr_epi8(1,2,4,8,16,32,64,-128,1,2,4,8,16,32,64,-128)),hi);
+	unsigned long long bits=~_mm512_test_epi8_mask(row,bit);
+	return bits?(unsigned)__builtin_ctzll(bits):64;
+}
+#endif
+#if defined(__SSSE3__)||defined(YSCAN_X86)
+#include <tmmintrin.h>
+static inline YTARGET("ssse3") unsigned yset_ssse3(const yset *set,const char *p)
+{
+	const __m128i nib=_mm_set1_epi8(0x0f);
+	__m128i v=_mm_loadu_si128((const __m128i*)p);
+	__m128i lo=_mm_and_si128(v,nib);
+	__m128i hi=_mm_and_si128(_mm_srli_epi16(v,4),nib);
+	__m128i rl=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)set->lo),lo);
+	__m128i rh=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)set->hi),lo);
+	__m128i sel=_mm_cmplt_epi8(hi,_mm_set1_epi8(8));
+	__m128i row=_mm_or_si128(_mm_and_si128(sel,rl),_mm_andnot_si128(sel,rh));
+	__m128i bit=_mm_shuffle_epi8(_mm_setr_epi8(1,2,4,8,16,32,64,-128,1,2,4,8,16,32,64,-128),hi);
+	unsigned bits=~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row,bit),bit))&0xffffu;
+	return bits?(unsigned)__builtin_ctz(bits):16;
+}
+#endif
+#if defined(__SSE2__)||defined(YSCAN_X86)
+/* skips whole 16-byte blocks with no byte in a stop run; only for nstop>0, the caller finishes the tail */
+static inline YTARGET("sse2") char *yset_runs_sse2(const yset *set,char *p,char *e)
+{
+	unsigned s4,l4;
+	__m128i s,l,s0,s1,s2,s3,l0,l1,l2,l3;
+	memcpy(&s4,set->stop,4);
+	memcpy(&l4,set->slen,4);
+	/* byte i of stop/slen to all 16 lanes of s_i/l_i; written for YSET_STOPS 4 */
+	s=_mm_cvtsi32_si128((int)s4);
+	s=_mm_unpacklo_epi16(_mm_unpacklo_epi8(s,s),_mm_unpacklo_epi8(s,s));
+	l=_mm_cvtsi32_si128((int)l4);
+	l=_mm_unpacklo_epi16(_mm_unpacklo_epi8(l,l),_mm_unpacklo_epi8(l,l));
+	s0=_mm_shuffle_epi32(s,0x00);s1=_mm_shuffle_epi32(s,0x55);
+	s2=_mm_shuffle_epi32(s,0xaa);s3=_mm_shuffle_epi32(s,0xff);
+	l0=_mm_shuffle_epi32(l,0x00);l1=_mm_shuffle_epi32(l,0x55);
+	l2=_mm_shuffle_epi32(l,0xaa);l3=_mm_shuffle_epi32(l,0xff);
+	while(e-p>=16){
+		__m128i v=_mm_loadu_si128((const __m128i*)p),t0,t1,t2,t3;
+		unsigned bits;
+		/* v-stop <= slen, unsigned, puts v in that run */
+		t0=_mm_sub_epi8(v,s0);t1=_mm_sub_epi8(v,s1);
+		t2=_mm_sub_epi8(v,s2);t3=_mm_sub_epi8(v,s3);
+		bits=(unsigned)_mm_movemask_epi8(_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(t0,l0),t0),_mm_cmpeq_epi8(_mm_min_epu8(t1,l1),t1)),
+			_mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(t2,l2),t2),_mm_cmpeq_epi8(_mm_min_epu8(t3,l3),t3))));
+		if(bits)return p+__builtin_ctz(bits);
+		p+=16;
+	}
+	return p;
+}
+#endif
+#if defined(__ARM_NEON)&&defined(__aarch64__)
+#define YSET_NEON 1
+static inline unsigned yset_neon(const yset *set,const char *p)
+{
+	static const uint8_t bt[16]={1,2,4,8,16,32,64,128,1,2,4,8,16,32,64,128};
+	uint8x16_t v=vld1q_u8((const uint8_t*)p);
+	uint8x16_t lo=vandq_u8(v,vdupq_n_u8(0x0f));
+	uint8x16_t hi=vshrq_n_u8(v,4);
+	uint8x16_t row=vbslq_u8(vcltq_u8(hi,vdupq_n_u8(8)),
+		vqtbl1q_u8(vld1q_u8(set->lo),lo),vqtbl1q_u8(vld1q_u8(set->hi),lo));
+	uint8x16_t in=vtstq_u8(row,vqtbl1q_u8(vld1q_u8(bt),hi));
+	uint64_t bits=~vget_lane_u64(vreinterpret_u64_u8(
+		vshrn_n_u16(vreinterpretq_u16_u8(in),4)),0);
+	return bits?(unsigned)__builtin_ctzll(bits)>>2:16;
+}
+#endif
+
+#if defined(YSCAN_DISPATCH)
+#elif defined(__AVX2__)
+#define YSET_BLOCK 32
+#define yset_block yset_avx2
+#elif defined(__SSSE3__)
+#define YSET_BLOCK 16
+#define yset_block yset_ssse3
+#elif defined(YSET_NEON)
+#define YSET_BLOCK 16
+#define yset_block yset_neon
+#elif defined(__SSE2__)
+#define YSET_RUNS 1
+#endif
+#endif
+
+#ifndef YSCAN_DISPATCH
+/* first byte of [p,e) not in set, or e */
+static inline char *yset_span(const yset *set,char *p,char *e)
+{
+#ifdef YSET_RUNS
+	if(set->nstop){
+		p=yset_runs_sse2(set,p,e);
+		if(p<e&&!yset_has(set,*p))return p;
+	}
+#endif
+#ifdef YSET_BLOCK
+	while(e-p>=YSET_BLOCK){
+		unsigned i=yset_block(set,p);
+		if(i<YSET_BLOCK)return p+i;
+		p+=YSET_BLOCK;
+	}
+#endif
+	while(p<e&&yset_has(set,*p))p++;
+	return p;
+}
+#endif
+
+/* ========================= KERNEL DISPATCH ========================= */
+
+/*
+ * Kernel variants, for builds that ship one binary to mixed machines.
+ * With YSCANF_DISPATCH (GCC or clang) the whitespace and scanset spans
+ * go through a per-translation-unit table. On x86 the SSE2, AVX2 and
+ * AVX-512 kernels are all compiled with target attributes, so no -m flag
+ * is needed, and the first yreader_init_*() picks the best one cpuid
+ * reports, publishing it atomically so concurrent readers are safe. On
+ * ARM the NEON kernels come with the compiler flags, as AArch64 always
+ * has them. ykernel_select() forces a variant (YKERN_BYTE also turns off
+ * the 8-digit SWAR integer path) for comparisons and tests, from any
+ * thread. Without YSCANF_DISPATCH the choice is made at compile time and
+ * ykernel_active() reports it.
+ */
+enum{YKERN_BEST=-1,YKERN_BYTE,YKERN_SWAR,YKERN_SSE2,YKERN_AVX2,YKERN_AVX512,YKERN_NEON,YKERN_COUNT};
+
+static inline const char *ykernel_name(int v)
+{
+	static const char *const names[YKERN_COUNT]={"byte","swar","sse2","avx2","avx512","neon"};
+	return v>=0&&v<YKERN_COUNT?names[v]:"?";
+}
+
+#ifdef YSCAN_DISPATCH
+
+/* the plain loops double as the tails of the block kernels */
+static inline char *yskip_ws_byte(char *p,char *e)
+{
+	while(p<e&&yisspace((unsigned char)*p))p++;
+	return p;
+}
+
+static inline char *yfind_ws_byte(char *p,char *e)
+{
+	while(p<e&&!yisspace((unsigned char)*p))p++;
+	return p;
+}
+
+static inline char *yset_span_byte(const yset *set,char *p,char *e)
+{
+	while(p<e&&yset_has(set,*p))p++;
+	return p;
+}
+
+/* skip/find spans over one block kernel, compiled for its target */
+#define YSCAN_SPANS(v,n,attr) \
+	static attr char *yskip_ws_##v(char *p,char *e) \
+	{ \
+		while(e-p>=n){unsigned i=yscan_##v(p,0);if(i<n)return p+i;p+=n;} \
+		return yskip_ws_byte(p,e); \
+	} \
+	static attr char *yfind_ws_##v(char *p,char *e) \
+	{ \
+		while(e-p>=n){unsigned i=yscan_##v(p,1);if(i<n)return p+i;p+=n;} \
+		return yfind_ws_byte(p,e); \
+	}
+#define YSET_SPAN(v,n,attr) \
+	static attr char *yset_span_##v(const yset *set,char *p,char *e) \
+	{ \
+		while(e-p>=n){unsigned i=yset_##v(set,p);if(i<n)return p+i;p+=n;} \
+		return yset_span_byte(set,p,e); \
+	}
+
+#ifdef YSCAN_SWAR
+YSCAN_SPANS(swar,8,)
+#endif
+#ifdef YSCAN_X86
+YSCAN_SPANS(sse2,16,YTARGET("sse2"))
+YSCAN_SPANS(avx2,32,YTARGET("avx2"))
+YSCAN_SPANS(avx512,64,YTARGET("avx512bw"))
+YSET_SPAN(ssse3,16,YTARGET("ssse3"))
+static YTARGET("sse2") char *yset_span_sse2(const yset *set,char *p,char *e)
+{
+	if(set->nstop){
+		p=yset_runs_sse2(set,p,e);
+		if(p<e&&!yset_has(set,*p))return p;
+	}
+	return yset_span_byte(set,p,e);
+}
+YSET_SPAN(avx2,32,YTARGET("avx2"))
+YSET_SPAN(avx512,64,YTARGET("avx512bw"))
+#endif
+#ifdef __ARM_NEON
+YSCAN_SPANS(neon,16,)
+#endif
+#ifdef YSET_NEON
+YSET_SPAN(neon,16,)
+#endif
+
+static char *yskip_ws_first(char *p,char *e);
+static char *yfind_ws_first(char *p,char *e);
+static char *yset_span_first(const yset *set,char *p,char *e);
+
+typedef struct ykernels{
+	char *(*skip_ws)(char *p,char *e);
+	char *(*find_ws)(char *p,char *e);
+	char *(*set_span)(const yset *set,char *p,char *e);
+	int digits8;	/* 8-digit SWAR integer path */
+	int active;	/* YKERN_*, or YKERN_BEST until resolved */
+}ykernels;
+
+/*
+ * ykern points at one immutable table per variant and is only swapped
+ * whole with release/acquire atomics, so readers on other threads see
+ * either the old table or the new one. It starts on stubs that resolve
+ * it; yreader_init_*() resolve it too.
+ */
+static const ykernels ykern_first={yskip_ws_first,yfind_ws_first,yset_span_first,1,YKERN_BEST};
+static const ykernels *ykern=&ykern_first;
+#define YKERN() __atomic_load_n(&ykern,__ATOMIC_ACQUIRE)
+
+static inline int ykernel_supported(int v)
+{
+#ifdef YSCAN_X86
+	__builtin_cpu_init();
+#endif
+	switch(v){
+	case YKERN_BYTE:return 1;
+#ifdef YSCAN_SWAR
+	case YKERN_SWAR:return 1;
+#endif
+#ifdef YSCAN_X86
+	case YKERN_SSE2:return __builtin_cpu_supports("sse2");
+	case YKERN_AVX2:return __builtin_cpu_supports("avx2");
+	case YKERN_AVX512:return __builtin_cpu_supports("avx512bw");
+#endif
+#ifdef __ARM_NEON
+	case YKERN_NEON:return 1;
+#endif
+	default:return 0;
+	}
+}
+
+/* the table for v (YKERN_BEST: the widest supported), NULL if v cannot run here */
+static inline const ykernels *ykernel_table(int v)
+{
+	static const ykernels byte={yskip_ws_byte,yfind_ws_byte,yset_span_byte,0,YKERN_BYTE};
+#ifdef YSCAN_SWAR
+	static const ykernels swar={yskip_ws_swar,yfind_ws_swar,yset_span_byte,1,YKERN_SWAR};
+#endif
+#ifdef YSCAN_X86
+	static const ykernels sse2={yskip_ws_sse2,yfind_ws_sse2,yset_span_sse2,1,YKERN_SSE2};
+	static const ykernels ssse3={yskip_ws_sse2,yfind_ws_sse2,yset_span_ssse3,1,YKERN_SSE2};
+	static const ykernels avx2={yskip_ws_avx2,yfind_ws_avx2,yset_span_avx2,1,YKERN_AVX2};
+	static const ykernels avx512={yskip_ws_avx512,yfind_ws_avx512,yset_span_avx512,1,YKERN_AVX512};
+#endif
+#ifdef __ARM_NEON
+#ifdef YSET_NEON
+	static const ykernels neon={yskip_ws_neon,yfind_ws_neon,yset_span_neon,1,YKERN_NEON};
+#else
+	static const ykernels neon={yskip_ws_neon,yfind_ws_neon,yset_span_byte,1,YKERN_NEON};
+#endif
+#endif
+	if(v==YKERN_BEST)
+		for(v=YKERN_COUNT-1;v>YKERN_BYTE&&!ykernel_supported(v);v--);
+	if(!ykernel_supported(v))return NULL;
+	switch(v){
+#ifdef YSCAN_SWAR
+	case YKERN_SWAR:return &swar;
+#endif
+#ifdef YSCAN_X86
+	case YKERN_SSE2:return __builtin_cpu_supports("ssse3")?&ssse3:&sse2;
+	case YKERN_AVX2:return &avx2;
+	case YKERN_AVX512:return &avx512;
+#endif
+#ifdef __ARM_NEON
+	case YKERN_NEON:return &neon;
+#endif
+	default:return &byte;
+	}
+}
+
+/*
+ * Forces variant v (YKERN_BEST: the widest supported); 0 if v cannot run
+ * here. Safe to call while other threads read: each scan uses whichever
+ * table was published when it started.
+ */
+static inline int ykernel_select(int v)
+{
+	const ykernels *t=ykernel_table(v);
+	if(!t)return 0;
+	__atomic_store_n(&ykern,t,__ATOMIC_RELEASE);
+	return 1;
+}
+
+/* publishes the best table unless one is already set (a ykernel_select() wins) */
+static YCOLD const ykernels *ykernel_resolve(void)
+{
+	const ykernels *want=&ykern_first;
+	__atomic_compare_exchange_n(&ykern,&want,ykernel_table(YKERN_BEST),0,__ATOMIC_ACQ_REL,__ATOMIC_ACQUIRE);
+	return YKERN();
+}
+
+static inline void ykernel_init(void)
+{
+	if(YUNLIKELY(YKERN()==&ykern_first))ykernel_resolve();
+}
+
+static inline int ykernel_active(void)
+{
+	ykernel_init();
+	return YKERN()->active;
+}
+
+static YCOLD char *yskip_ws_first(char *p,char *e){return ykernel_resolve()->skip_ws(p,e);}
+static YCOLD char *yfind_ws_first(char *p,char *e){return ykernel_resolve()->find_ws(p,e);}
+static YCOLD char *yset_span_first(const yset *set,char *p,char *e){return ykernel_resolve()->set_span(set,p,e);}
+
+/* first non-space byte in [p,e), or e */
+static inline char *yskip_ws_span(char *p,char *e){return YKERN()->skip_ws(p,e);}
+/* first space byte in [p,e), or e */
+static inline char *yfind_ws_span(char *p,char *e){return YKERN()->find_ws(p,e);}
+/* first byte of [p,e) not in set, or e */
+static inline char *yset_span(const yset *set,char *p,char *e){return YKERN()->set_span(set,p,e);}
+#define YDIGITS8 YKERN()->digits8
+
+#else
+
+/* the compile-time choice */
+static inline int ykernel_active(void)
+{
+#if defined(YSCAN_BLOCK)&&YSCAN_BLOCK==32
+	return YKERN_AVX2;
+#elif defined(YSCAN_BLOCK)&&YSCAN_BLOCK==8
+	return YKERN_SWAR;
+#elif defined(YSCAN_BLOCK)&&defined(__ARM_NEON)
+	return YKERN_NEON;
+#elif defined(YSCAN_BLOCK)
+	return YKERN_SSE2;
+#else
+	return YKERN_BYTE;
+#endif
+}
+
+static inline int ykernel_supported(int v){return v==ykernel_active();}
+static inline int ykernel_select(int v){return v==YKERN_BEST||v==ykernel_active();}
+static inline void ykernel_init(void){}
+#define YDIGITS8 1
+
+#endif
+
+/* ========================= CORE IO ========================= */
+
+/*
+ * Refill that keeps the last keep bytes: they are moved to the front of
+ * the buffer (grown if they fill it) and new input is read after them.
+ * A mark holds the bytes from it on as well. Only for the fread/read
+ * buffer, never a mapping or prefetch slot.
+ */
+static YCOLD int yrefill_keep_r(yreader *r,size_t keep)
+{
+	size_t len,held=keep,at=0;
+	if(r->eof)return 0;
+	if(r->mark&&(size_t)(r->end-r->mark)>held)held=(size_t)(r->end-r->mark);
+	if(r->mark)at=held-(size_t)(r->end-r->mark);
+	memmove(r->buf,r->end-held,held);
+	if(held==r->cap&&!ybuf_grow_r(r,r->cap*2,held)){
+		r->end=r->buf+held;
+		r->ptr=r->end-keep;
+		if(r->mark)r->mark=r->buf+at;
+		return 0;
+	}
+	r->end=r->buf+held;
+	r->ptr=r->end-keep;
+	if(r->mark)r->mark=r->buf+at;
+	len=ysrc_read_r(r,r->end,r->cap-held);
+	r->end+=len;
+	ybuf_seal_r(r);
+	if(!len){r->eof=1;return 0;}
+	return 1;
+}
+
+static YCOLD int yrefill_src_r(yreader *r)
+{
+	size_t len;
+	if(r->eof)return 0;
+	if(r->src==YSRC_MEM){r->eof=1;return 0;}
+#if defined(YSCANF_PREFETCH)&&defined(YSCANF_HAVE_POSIX)
+	if(r->pf){r->mark=NULL;return ypf_next_r(r);}
+#endif
+#ifdef YSCANF_HAVE_MMAP
+	if(r->map_state==1){r->eof=1;return 0;}
+	if(!r->map_state&&ymap_r(r))return 1;
+#endif
+	if(YUNLIKELY(r->mark!=NULL))return yrefill_keep_r(r,(size_t)(r->end-r->ptr));
+	if(!r->buf&&!ybuf_alloc_r(r)){r->eof=1;return 0;}
+	len=ysrc_read_r(r,r->buf,r->cap);
+	if(!len){r->eof=1;return 0;}
+	r->ptr=r->buf;
+	r->end=r->buf+len;
+	ybuf_seal_r(r);
+	return 1;
+}
+
+#ifdef YSCANF_STATS
+/* a token straddles when both sides of the refill are non-space */
+static YCOLD int yrefill_r(yreader *r)
+{
+	int edge=r->src!=YSRC_MEM&&r->end&&r->ptr==r->end&&!yisspace((unsigned char)r->end[-1]);
+	int ok=yrefill_src_r(r);
+	if(ok&&edge&&!yisspace((unsigned char)*r->ptr))r->stats.straddles++;
+	return ok;
+}
+#else
+static inline int yrefill_r(yreader *r){return yrefill_src_r(r);}
+#endif
+
+static inline int yget_r(yreader *r)
+{
+	if(YUNLIKELY(r->ptr>=r->end)&&!yrefill_r(r))return EOF;
+	return (unsigned char)*r->ptr++;
+}
+
+static inline int ypeek_r(yreader *r)
+{
+	if(YUNLIKELY(r->ptr>=r->end)&&!yrefill_r(r))return EOF;
+	return (unsigned char)*r->ptr;
+}
+
+/*
+ * Speculative parsing: yreader_mark() remembers the position and
+ * yreader_rewind() goes back to it, so "try an int, else a string" needs
+ * neither a second pass nor sscanf. Until yreader_unmark(), refills keep
+ * the bytes from the mark on (growing the buffer if needed); mappings and
+ * memory spans hold everything anyway. A prefetching reader drops the mark
+ * when it switches slots; rewind then returns 0.
+ */
+static inline void yreader_mark(yreader *r)
+{
+	ypeek_r(r);
+	r->mark=r->ptr;
+}
+
+static inline int yreader_rewind(yreader *r)
+{
+	if(!r->mark)return 0;
+	r->ptr=r->mark;
+	return 1;
+}
+
+static inline void yreader_unmark(yreader *r){r->mark=NULL;}
+
+static inline void yskip_space_r(yreader *r)
+{
+	/* most tokens are preceded by none or one separator */
+	if(YLIKELY(r->end-r->ptr>=2)){
+		if(!yisspace((unsigned char)r->ptr[0]))return;
+		if(!yisspace((unsigned char)r->ptr[1])){r->ptr++;YSTAT(r->stats.ws_bytes++);return;}
+	}
+	for(;;){
+		char *q=yskip_ws_span(r->ptr,r->end);
+		YSTAT(r->stats.ws_bytes+=(unsigned long long)(q-r->ptr));
+		r->ptr=q;
+		if(YLIKELY(r->ptr<r->end)||!yrefill_r(r))return;
+	}
+}
+
+/* ========================= DIGITS ========================= */
+
+/*
+ * yparse_digits_r() accumulates a decimal run into 64 bits. With at least
+ * 16 buffered bytes, or a padded buffer, it converts 8 digits per step with
+ * the SWAR multiply-shift reduction; runs that reach the end of the buffer
+ * go through the byte loop so they can straddle a refill. On a padded
+ * buffer that loop stops at the sentinel instead of testing end. At most 16 digits
+ * are taken on the fast path, and no 19-digit run can wrap 64 bits, so
+ * only the 20th digit onwards goes through the checked multiply.
+ */
+#if !defined(YSCANF_NO_SIMD)&&(defined(__GNUC__)||defined(__clang__))&& \
+	defined(__BYTE_ORDER__)&&__BYTE_ORDER__==__ORDER_LITTLE_ENDIAN__
+#define YSCANF_SWAR_DIGITS 1
+
+/* number of leading ASCII digits in 8 bytes */
+static inline unsigned ydigit_run8(unsigned long long x)
+{
+	const unsigned long long h=0x8080808080808080ULL,l=0x0101010101010101ULL;
+	unsigned long long ge0=((x|h)-l*'0')&h;
+	unsigned long long ge10=((x|h)-l*('9'+1))&h;
+	unsigned long long nd=~(ge0&~ge10&~x)&h;
+	return nd?(unsigned)__builtin_ctzll(nd)>>3:8;
+}
+
+/* value of 8 ASCII digits, first digit in the lowest byte */
+static inline unsigned long long yswar_parse8(unsigned long long x)
+{
+	x&=0x0F0F0F0F0F0F0F0FULL;
+	x=(x*10+(x>>8))&0x00FF00FF00FF00FFULL;
+	x=(x*100+(x>>16))&0x0000FFFF0000FFFFULL;
+	return (x*10000+(x>>32))&0xFFFFFFFFULL;
+}
+
+/* value of the first n (1..8) digits of x */
+static inline unsigned long long yswar_parsen(unsigned long long x,unsigned n)
+{
+	return yswar_parse8(x<<(8*(8-n)));
+}
+#endif
+
+/* x*10+d with *ovf set on a 64-bit wrap; only used past digit 19 */
+static inline unsigned long long yacc_digit(unsigned long long x,int d,int *ovf)
+{
+#if (defined(__GNUC__)&&__GNUC__>=5)||defined(__clang__)
+	unsigned long long y;
+	if(__builtin_mul_overflow(x,10ULL,&y)|__builtin_add_overflow(y,(unsigned long long)d,&y))*ovf=1;
+	return y;
+#else
+	if(YUNLIKELY(x>=1844674407370955161ULL)&&(x>1844674407370955161ULL||d>5))*ovf=1;
+	return x*10+(unsigned)d;
+#endif
+}
+
+/*
+ * returns the digit count (0 if none); *ovf is set if the run exceeds 64
+ * bits, unless pol is YOVF_UNCHECKED, which wraps without checking
+ */
+static inline unsigned long long ydigit_step(unsigned long long x,int d,int n,int *ovf,int pol)
+{
+	if(YLIKELY(n<19)||pol==YOVF_UNCHECKED)return x*10+(unsigned)d;
+	return yacc_digit(x,d,ovf);
+}
+
+static inline int yparse_digits_r(yreader *r,unsigned long long *out,int *ovf,int pol)
+{
+	unsigned long long x=0;
+	const unsigned char *p;
+	int n=0;
+	*ovf=0;
+#ifdef YSCANF_SWAR_DIGITS
+	/* with padding the loads may run past end; the sentinel ends the run */
+	if(YLIKELY((r->end-r->ptr>=16||r->pad)&&YDIGITS8)){
+		static const unsigned long long p10[9]={
+			1,10,100,1000,10000,100000,1000000,10000000,100000000};
+		unsigned long long a,b;
+		unsigned na,nb;
+		memcpy(&a,r->ptr,8);
+		na=ydigit_run8(a);
+		if(na<8){
+			r->ptr+=na;
+			x=na?yswar_parsen(a,na):0;
+			n=(int)na;
+		}
+		else{
+			memcpy(&b,r->ptr+8,8);
+			nb=ydigit_run8(b);
+			x=yswar_parse8(a);
+			if(nb<8){
+				r->ptr+=8+nb;
+				x=nb?x*p10[nb]+yswar_parsen(b,nb):x;
+				n=8+(int)nb;
+			}
+			else{
+				x=x*100000000+yswar_parse8(b);
+				r->ptr+=16;
+				n=16;
+			}
+		}
+		/* a run that stops at the sentinel may go on after a refill */
+		if(YLIKELY(n<16&&r->ptr<r->end)){
+			*out=x;
+			return n;
+		}
+	}
+#endif
+	for(;;){
+		p=(const unsigned char*)r->ptr;
+		if(r->pad)
+			for(;yisdigit(*p);p++,n++)x=ydigit_step(x,*p-'0',n,ovf,pol);
+		else
+			for(;p<(const unsigned char*)r->end&&yisdigit(*p);p++,n++)x=ydigit_step(x,*p-'0',n,ovf,pol);
+		r->ptr=(char*)p;
+		if(p<(const unsigned char*)r->end||!yrefill_r(r))break;
+	}
+	*out=x;
+	return n;
+}
+
+/* ========================= READERS ========================= */
+
+/* a sign is the last buffered byte: 1 once the byte after it is buffered too */
+static YCOLD int ysign_tail_r(yreader *r)
+{
+	if(r->eof||r->src==YSRC_MEM||r->map_state==1)return 0;
+	if(r->pf){
+		/* prefetch slots cannot keep bytes: here the sign is consumed */
+		r->ptr++;
+		return yrefill_r(r)?2:0;
+	}
+	if(!yrefill_keep_r(r,1))return 0;
+	/* counted like yrefill_r(): both sides of the refill are non-space */
+	YSTAT(r->stats.straddles+=!yisspace((unsigned char)r->ptr[1]));
+	return 1;
+}
+
+/*
+ * Takes the sign only if a digit follows, so a failed conversion leaves
+ * "-x" or a lone "+" unread. On return *r->ptr is the first digit.
+ */
+static inline int yread_sign_r(yreader *r,int *neg)
+{
+	int c,s,k;
+	yskip_space_r(r);
+	c=ypeek_r(r);
+	if(c==EOF)return 0;
+	/* branch-free sign: random signs would otherwise mispredict */
+	*neg=(c=='-');
+	s=(yctype[c]&YC_SIGN)!=0;
+	if(YUNLIKELY(r->ptr+s>=r->end)){
+		if(!(k=ysign_tail_r(r)))return 0;
+		if(k==2)s=0;
+	}
+	if(!yisdigit((unsigned char)r->ptr[s]))return 0;
+	r->ptr+=s;
+	return 1;
+}
+
+/*
+ * Digit-count fast acceptance: a run of at most 9 digits fits int32 and
+ * at most 18 fits int64, so those skip the range check entirely; leading
+ * zeros only push a value onto the exact check
+ */
+
+static inline int yread_i64_r(yreader *r,long long *out,int pol)
+{
+	int n,neg,ovf;
+	unsigned long long x;
+	if(!yread_sign_r(r,&neg)||!(n=yparse_digits_r(r,&x,&ovf,pol)))return 0;
+	if(pol!=YOVF_UNCHECKED&&YUNLIKELY(n>18)&&(ovf||x>(unsigned long long)LLONG_MAX+neg)){
+		if(pol==YOVF_FAIL)return 0;
+		*out=neg?LLONG_MIN:LLONG_MAX;
+	}
+	else
+		*out=neg?(long long)(0-x):(long long)x;
+	return 1;
+}
+
+static inline int yread_i32_r(yreader *r,int *out,int pol)
+{
+	int n,neg,ovf;
+	unsigned long long x;
+	if(!yread_sign_r(r,&neg)||!(n=yparse_digits_r(r,&x,&ovf,pol)))return 0;
+	if(pol!=YOVF_UNCHECKED&&YUNLIKELY(n>9)&&(ovf||x>(unsigned long long)INT_MAX+neg)){
+		if(pol==YOVF_FAIL)return 0;
+		*out=neg?INT_MIN:INT_MAX;
+	}
+	else
+		*out=neg?(int)(0u-(unsigned)x):(int)(unsigned)x;
+	return 1;
+}
+
+static inline int yread_u64_r(yreader *r,unsigned long long *out,int pol)
+{
+	int ovf;
+	unsigned long long x;
+	yskip_space_r(r);
+	if(!yisdigit(ypeek_r(r)))return 0;
+	yparse_digits_r(r,&x,&ovf,pol);
+	if(YUNLIKELY(ovf)){
+		if(pol==YOVF_FAIL)return 0;
+		x=ULLONG_MAX;
+	}
+	*out=x;
+	return 1;
+}
+
+static inline int yread_u32_r(yreader *r,unsigned *out,int pol)
+{
+	int n,ovf;
+	unsigned long long x;
+	yskip_space_r(r);
+	if(!yisdigit(ypeek_r(r)))return 0;
+	n=yparse_digits_r(r,&x,&ovf,pol);
+	if(pol!=YOVF_UNCHECKED&&YUNLIKELY(n>9)&&(ovf||x>UINT_MAX)){
+		if(pol==YOVF_FAIL)return 0;
+		x=UINT_MAX;
+	}
+	*out=(unsigned)x;
+	return 1;
+}
+
+static inline int yread_ll_ovf_r(yreader *r,long long *out,int pol)
+{
+	if(!yread_i64_r(r,out,pol))return 0;
+	YSTAT(r->stats.lls++);
+	return 1;
+}
+
+static inline int yread_ull_ovf_r(yreader *r,unsigned long long *out,int pol)
+{
+	if(!yread_u64_r(r,out,pol))return 0;
+	YSTAT(r->stats.lls++);
+	return 1;
+}
+
+static inline int yread_int_ovf_r(yreader *r,int *out,int pol)
+{
+	if(!yread_i32_r(r,out,pol))return 0;
+	YSTAT(r->stats.ints++);
+	return 1;
+}
+
+static inline int yread_uint_ovf_r(yreader *r,unsigned *out,int pol)
+{
+	if(!yread_u32_r(r,out,pol))return 0;
+	YSTAT(r->stats.ints++);
+	return 1;
+}
+
+static inline int yread_ll_ok_r(yreader *r,long long *out){return yread_ll_ovf_r(r,out,YSCANF_OVERFLOW);}
+static inline int yread_ull_ok_r(yreader *r,unsigned long long *out){return yread_ull_ovf_r(r,out,YSCANF_OVERFLOW);}
+static inline int yread_int_ok_r(yreader *r,int *out){return yread_int_ovf_r(r,out,YSCANF_OVERFLOW);}
+static inline int yread_uint_ok_r(yreader *r,unsigned *out){return yread_uint_ovf_r(r,out,YSCANF_OVERFLOW);}
+
+static inline int yf_peek_r(void *r){return ypeek_r((yreader*)r);}
+static inline int yf_next_r(void *r){return yget_r((yreader*)r);}
+
+/* correctly rounded (matches strtod); see yscanf_float.h */
+static inline int yread_double_ok_r(yreader *r,double *out)
+{
+	const char *q;
+	int more;
+	yskip_space_r(r);
+	if(r->ptr>=r->end)return 0;
+	q=yparse_double_span(r->ptr,r->end,out,&more);
+	if(YUNLIKELY(more)&&r->src!=YSRC_MEM){
+		/*
+		 * the number may continue past the buffer: re-read it as a stream,
+		 * holding the bytes so what the parse leaves ("1e+", "nan(") is unread
+		 */
+		yf_text t;
+		int ok,own=!r->mark;
+		size_t at;
+		if(own)r->mark=r->ptr;
+		at=(size_t)(r->ptr-r->mark);
+		yf_capture(&t,r,yf_peek_r,yf_next_r);
+		q=yparse_double_span(t.s,t.s+t.len,out,&more);
+		ok=q!=t.s;
+		if(r->mark)r->ptr=r->mark+at+(size_t)(q-t.s);
+		if(own)r->mark=NULL;
+		yf_text_free(&t);
+		YSTAT(r->stats.doubles+=ok);
+		return ok;
+	}
+	if(q==r->ptr)return 0;
+	r->ptr=(char*)q;
+	YSTAT(r->stats.doubles++);
+	return 1;
+}
+
+static inline int yread_str_ok_r(yreader *r,char *s)
+{
+	yskip_space_r(r);
+	if(ypeek_r(r)==EOF)return 0;
+	for(;;){
+		char *q=yfind_ws_span(r->ptr,r->end);
+		size_t n=(size_t)(q-r->ptr);
+		memcpy(s,r->ptr,n);
+		s+=n;
+		r->ptr=q;
+		if(q<r->end||!yrefill_r(r))break;
+	}
+	*s=0;
+	YSTAT(r->stats.strs++);
+	return 1;
+}
+
+/* %Ns: at most width bytes of the token go to s (width+1 bytes); the rest stays unread */
+static inline int yread_strn_ok_r(yreader *r,char *s,size_t width)
+{
+	size_t got=0;
+	yskip_space_r(r);
+	if(!width||ypeek_r(r)==EOF)return 0;
+	for(;;){
+		char *e=(size_t)(r->end-r->ptr)>width-got?r->ptr+(width-got):r->end;
+		char *q=yfind_ws_span(r->ptr,e);
+		memcpy(s+got,r->ptr,(size_t)(q-r->ptr));
+		got+=(size_t)(q-r->ptr);
+		r->ptr=q;
+		if(q<r->end||got==width||!yrefill_r(r))break;
+	}
+	s[got]=0;
+	YSTAT(r->stats.strs++);
+	return 1;
+}
+
+/*
+ * %N[...]: the longest run of set members, at most width bytes, goes to s
+ * (width+1 bytes; (size_t)-1 for no limit). Like scanf, leading whitespace
+ * is not skipped and an empty match fails, leaving s unchanged.
+ */
+static inline int yread_set_ok_r(yreader *r,const yset *set,char *s,size_t width)
+{
+	size_t got=0;
+	while(got<width&&(r->ptr<r->end||yrefill_r(r))){
+		char *e=(size_t)(r->end-r->ptr)>width-got?r->ptr+(width-got):r->end;
+		char *q=yset_span(set,r->ptr,e);
+		memcpy(s+got,r->ptr,(size_t)(q-r->ptr));
+		got+=(size_t)(q-r->ptr);
+		r->ptr=q;
+		if(q<r->end)break;
+	}
+	if(!got)return 0;
+	s[got]=0;
+	YSTAT(r->stats.strs++);
+	return 1;
+}
+
+/* prefetch slots cannot be compacted: gather the token in r->buf instead */
+static YCOLD int yview_join_r(yreader *r,ystr *v)
+{
+	size_t n=0;
+	for(;;){
+		char *q=yfind_ws_span(r->ptr,r->end);
+		size_t k=(size_t)(q-r->ptr);
+		if(n+k>r->cap){
+			size_t cap=r->cap?r->cap:256;
+			while(cap<n+k)cap*=2;
+			if(!ybuf_grow_r(r,cap,n))return 0;
+		}
+		memcpy(r->buf+n,r->ptr,k);
+		n+=k;
+		r->ptr=q;
+		if(q<r->end||!yrefill_r(r))break;
+	}
+	v->ptr=r->buf;
+	v->len=n;
+	YSTAT(r->stats.strs++);
+	return 1;
+}
+
+/*
+ * Zero-copy %s: v points into the reader's buffer, mapping or memory span.
+ * The bytes stay valid until the next read that refills the buffer, so
+ * hash or copy them before reading on; memory and mmap'd readers never
+ * refill, so their views live as long as the input. A token that straddles
+ * the buffer end is compacted to the buffer front, not copied out.
+ */
+static inline int yread_view_ok_r(yreader *r,ystr *v)
+{
+	char *q;
+	size_t seen=0;
+	yskip_space_r(r);
+	if(ypeek_r(r)==EOF)return 0;
+	while((q=yfind_ws_span(r->ptr+seen,r->end))==r->end&&!r->eof&&r->src!=YSRC_MEM){
+#ifdef YSCANF_HAVE_MMAP
+		if(r->map_state==1)break;
+#endif
+		if(r->pf)return yview_join_r(r,v);
+		seen=(size_t)(r->end-r->ptr);
+		if(!yrefill_keep_r(r,seen)){q=r->end;break;}
+		/* counted like yrefill_r(): both sides of the refill are non-space */
+		YSTAT(r->stats.straddles+=!yisspace((unsigned char)r->ptr[seen]));
+	}
+	v->ptr=r->ptr;
+	v->len=(size_t)(q-r->ptr);
+	r->ptr=q;
+	YSTAT(r->stats.strs++);
+	return 1;
+}
+
+static inline int yread_line_ok_r(yreader *r,char *s,int maxlen)
+{
+	int c,len=0;
+
+	while(1){
+		c=yget_r(r);
+		if(c==EOF)return 0;
+		if(c=='\n'||c=='\r')continue;
+		while(c!=EOF&&c!='\n'&&c!='\r'){
+			if(len<maxlen-1)
+				s[len++]=(char)c;
+			c=yget_r(r);
+		}
+		if(c=='\r'&&ypeek_r(r)=='\n')
+			yget_r(r);
+		s[len]=0;
+		return 1;
+	}
+}
+
+static inline int ygetline_ok_r(yreader *r,char *s,int maxlen)
+{
+	int c,len=0;
+	c=yget_r(r);
+	if(c==EOF)return 0;
+	while(c!=EOF&&c!='\n'&&c!='\r'){
+		if(len<maxlen-1)
+			s[len++]=(char)c;
+		c=yget_r(r);
+	}
+	if(c=='\r'&&ypeek_r(r)=='\n')
+		yget_r(r);
+	s[len]=0;
+	return 1;
+}
+
+/* ========================= BULK READERS ========================= */
+
+/*
+ * Fill out[0..n) from the input in one loop, with no format string or
+ * varargs per element. Returns the number of elements parsed; a short
+ * count means EOF or a non-numeric token stopped the run (same rules as the
+ * matching _ok reader).
+ */
+static inline size_t yread_int_array_r(yreader *r,int *out,size_t n)
+{
+	size_t i=0;
+	while(i<n&&yread_int_ok_r(r,out+i))i++;
+	return i;
+}
+
+static inline size_t yread_ll_array_r(yreader *r,long long *out,size_t n)
+{
+	size_t i=0;
+	while(i<n&&yread_ll_ok_r(r,out+i))i++;
+	return i;
+}
+
+static inline size_t yread_double_array_r(yreader *r,double *out,size_t n)
+{
+	size_t i=0;
+	while(i<n&&yread_double_ok_r(r,out+i))i++;
+	return i;
+}
+
+/* ========================= ARENA ========================= */
+
+/*
+ * Bump allocator for parsed data. Blocks are chained and released together
+ * by yarena_free(), so pointers into the arena stay valid until then;
+ * yarena_reset() drops everything but keeps one block for the next batch.
+ * The newest allocation can grow in place while its block has room, which
+ * is what the column readers use for their growable arrays.
+ */
+typedef struct yarena_blk{
+	struct yarena_blk *next;
+	size_t cap,used;
+}yarena_blk;
+
+typedef struct yarena{
+	yarena_blk *head;
+	size_t blk;	/* minimum block size */
+	void *last;	/* newest allocation */
+}yarena;
+
+#define YARENA_HDR ((sizeof(yarena_blk)+15)&~(size_t)15)
+
+/* blk is the minimum block size, 0 for 64 KiB */
+static inline void yarena_init(yarena *a,size_t blk)
+{
+	a->head=NULL;
+	a->blk=blk?blk:(size_t)1<<16;
+	a->last=NULL;
+}
+
+static YCOLD yarena_blk *yarena_block(yarena *a,size_t n)
+{
+	size_t cap=a->blk>n?a->blk:n;
+	yarena_blk *b=(yarena_blk*)malloc(YARENA_HDR+cap);
+	if(!b)return NULL;
+	b->next=a->head;
+	b->cap=cap;
+	b->used=0;
+	a->head=b;
+	return b;
+}
+
+/* n bytes at a multiple of align (a power of two up to 16) */
+static inline void *yarena_take(yarena *a,size_t n,size_t align)
+{
+	yarena_blk *b=a->head;
+	size_t at=b?(b->used+align-1)&~(align-1):0;
+	if(YUNLIKELY(!b||at>b->cap||b->cap-at<n)){
+		if(!(b=yarena_block(a,n)))return NULL;
+		at=0;
+	}
+	b->used=at+n;
+	return a->last=(char*)b+YARENA_HDR+at;
+}
+
+/* 16-byte aligned; NULL if out of memory */
+static inline void *yarena_alloc(yarena *a,size_t n)
+{
+	return yarena_take(a,(n+15)&~(size_t)15,16);
+}
+
+/* a NUL-terminated copy of p[0..n), packed with no alignment padding */
+static inline char *yarena_strndup(yarena *a,const char *p,size_t n)
+{
+	char *q=(char*)yarena_take(a,n+1,1);
+	if(!q)return NULL;
+	memcpy(q,p,n);
+	q[n]=0;
+	return q;
+}
+
+/* resizes p from old to n bytes: in place if p is the newest allocation and fits */
+static inline void *yarena_grow(yarena *a,void *p,size_t old,size_t n)
+{
+	yarena_blk *b=a->head;
+	char *q;
+	if(p&&p==a->last){
+		size_t at=(size_t)((char*)p-((char*)b+YARENA_HDR));
+		if(n<=b->cap-at){
+			b->used=at+((n+15)&~(size_t)15);
+			return p;
+		}
+	}
+	q=(char*)yarena_alloc(a,n);
+	if(q&&p)memcpy(q,p,old<n?old:n);
+	return q;
+}
+
+static inline void yarena_free(yarena *a)
+{
+	while(a->head){
+		yarena_blk *b=a->head;
+		a->head=b->next;
+		free(b);
+	}
+	a->last=NULL;
+}
+
+/* invalidates every allocation; the newest block is kept and reused */
+static inline void yarena_reset(yarena *a)
+{
+	yarena_blk *b=a->head;
+	if(!b)return;
+	a->head=b->next;
+	yarena_free(a);
+	b->next=NULL;
+	b->used=0;
+	a->head=b;
+}
+
+/* ========================= ARENA STRINGS ========================= */
+
+/*
+ * yread_astr_ok_r() is %s with no caller buffer: the token is copied into
+ * an arena, NUL-terminated, and stays valid across refills until the arena
+ * is reset or freed. yread_intern_ok_r() also deduplicates: equal tokens
+ * return the same pointer and a dense id (0, 1, ... in first-seen order),
+ * so repeated symbols cost a hash lookup and no allocation. The table only
+ * allocates when it doubles; its strings live in the arena given to
+ * yintern_init(), so clear the table whenever that arena is reset.
+ */
+static inline int yread_astr_ok_r(yreader *r,yarena *a,ystr *out)
+{
+	ystr v;
+	char *q;
+	if(!yread_view_ok_r(r,&v)||!(q=yarena_strndup(a,v.ptr,v.len)))return 0;
+	out->ptr=q;
+	out->len=v.len;
+	return 1;
+}
+
+typedef struct yintern{
+	yarena *arena;
+	ystr *sym;	/* by id */
+	unsigned *hash;	/* by id */
+	unsigned *slot;	/* open addressing: id+1, 0 if empty */
+	unsigned n,cap,mask;
+}yintern;
+
+static inline void yintern_init(yintern *t,yarena *a)
+{
+	memset(t,0,sizeof(*t));
+	t->arena=a;
+}
+
+static inline void yintern_free(yintern *t)
+{
+	free(t->sym);
+	free(t->hash);
+	free(t->slot);
+	t->sym=NULL;
+	t->hash=t->slot=NULL;
+	t->n=t->cap=t->mask=0;
+}
+
+/* forgets every symbol and keeps the table's memory, e.g. after yarena_reset() */
+static inline void yintern_clear(yintern *t)
+{
+	if(t->slot)memset(t->slot,0,((size_t)t->mask+1)*sizeof(*t->slot));
+	t->n=0;
+}
+
+/* word-at-a-time multiplicative hash; symbols are usually one or two words */
+static inline unsigned yintern_hash(const char *p,size_t n)
+{
+	unsigned long long h=0x9E3779B97F4A7C15ULL^n,w;
+	for(;n>=8;p+=8,n-=8){
+		memcpy(&w,p,8);
+		h=(h^w)*0xFF51AFD7ED558CCDULL;
+	}
+	if(n){
+		w=0;
+		memcpy(&w,p,n);
+		h=(h^w)*0xFF51AFD7ED558CCDULL;
+	}
+	return (unsigned)(h^h>>32);
+}
+
+/* doubles the symbol arrays and rebuilds the slots at twice the symbols */
+static YCOLD int yintern_grow(yintern *t)
+{
+	unsigned cap=t->cap?t->cap*2:64,i,mask=cap*2-1;
+	ystr *sym=(ystr*)realloc(t->sym,cap*sizeof(*sym));
+	unsigned *hash,*slot;
+	if(!sym)return 0;
+	t->sym=sym;
+	if(!(hash=(unsigned*)realloc(t->hash,cap*sizeof(*hash))))return 0;
+	t->hash=hash;
+	if(!(slot=(unsigned*)calloc((size_t)mask+1,sizeof(*slot))))return 0;
+	for(i=0;i<t->n;i++){
+		unsigned k=hash[i]&mask;
+		while(slot[k])k=(k+1)&mask;
+		slot[k]=i+1;
+	}
+	free(t->slot);
+	t->slot=slot;
+	t->mask=mask;
+	t->cap=cap;
+	return 1;
+}
+
+/* the id of p[0..n), added if new; *out (if given) is the interned copy; -1 if out of memory */
+static inline int yintern_get(yintern *t,const char *p,size_t n,ystr *out)
+{
+	unsigned h=yintern_hash(p,n),k=0,id;
+	char *q;
+	if(t->slot){
+		for(k=h&t->mask;(id=t->slot[k])!=0;k=(k+1)&t->mask){
+			const ystr *s=&t->sym[id-1];
+			if(t->hash[id-1]==h&&s->len==n&&!memcmp(s->ptr,p,n)){
+				if(out)*out=*s;
+				return (int)id-1;
+			}
+		}
+	}
+	if(YUNLIKELY(t->n==t->cap||t->n>=(unsigned)INT_MAX)){
+		if(t->n>=(unsigned)INT_MAX||!yintern_grow(t))return -1;
+		for(k=h&t->mask;t->slot[k];k=(k+1)&t->mask);
+	}
+	if(!(q=yarena_strndup(t->arena,p,n)))return -1;
+	id=t->n++;
+	t->sym[id].ptr=q;
+	t->sym[id].len=n;
+	t->hash[id]=h;
+	t->slot[k]=id+1;
+	if(out)*out=t->sym[id];
+	return (int)id;
+}
+
+/* a %s token, interned; *id (if given) is its symbol id */
+static inline int yread_intern_ok_r(yreader *r,yintern *t,ystr *out,int *id)
+{
+	ystr v;
+	int i;
+	if(!yread_view_ok_r(r,&v)||(i=yintern_get(t,v.ptr,v.len,out))<0)return 0;
+	if(id)*id=i;
+	return 1;
+}
+
+/* ========================= RECORDS ========================= */
+
+/*
+ * Line-oriented batch parsing: a yrecord describes the fields of one line
+ * (a yscanf-style format plus the offsetof() of each field in the struct)
+ * and yread_records_r() parses lines straight from the buffer into an
+ * array of those structs, each byte read once. Fields are separated by
+ * blanks and may not cross a newline. A bad line is skipped and reported
+ * in its status slot, and the batch goes on. %S views point into the
+ * buffer, so they only outlive the batch for memory or mapped readers.
+ */
+#define YREC_MAX 16
+
+enum{YFLD_INT,YFLD_UINT,YFLD_LL,YFLD_ULL,YFLD_DOUBLE,YFLD_STR,YFLD_VIEW,YFLD_CHAR};
+
+typedef struct yrecord{
+	int n;	/* fields per line */
+	size_t size;	/* distance between records, usually sizeof */
+	unsigned char type[YREC_MAX];
+	size_t off[YREC_MAX];
+	size_t width[YREC_MAX];	/* %Ns limit, 0 if none */
+}yrecord;
+
+/*
+ * fmt takes %d %u %lld %llu %f/%e/%g (l optional) %s %Ns %S %c; 0 if
+ * unsupported. %Ns stores at most N bytes plus the NUL, and a longer token
+ * makes its line bad; a bare %s is unbounded like yread_str_ok_r(). off may
+ * be NULL for a schema used only by the column readers.
+ */
+static inline int yrecord_init(yrecord *rec,const char *fmt,const size_t *off,size_t size)
+{
+	size_t width;
+	int t;
+	rec->n=0;
+	rec->size=size;
+	for(;*fmt;fmt++){
+		if(*fmt!='%')continue;
+		fmt++;
+		for(width=0;yisdigit((unsigned char)*fmt);fmt++)width=width*10+(size_t)(*fmt-'0');
+		if(width&&*fmt!='s')return 0;
+		if(*fmt=='l'&&fmt[1]=='l'){
+			fmt+=2;
+			if(*fmt=='d')t=YFLD_LL;
+			else if(*fmt=='u')t=YFLD_ULL;
+			else return 0;
+		}
+		else{
+			if(*fmt=='l')fmt++;
+			switch(*fmt){
+			case 'd':t=YFLD_INT;break;
+			case 'u':t=YFLD_UINT;break;
+			case 'f':case 'e':case 'g':t=YFLD_DOUBLE;break;
+			case 's':t=YFLD_STR;break;
+			case 'S':t=YFLD_VIEW;break;
+			case 'c':t=YFLD_CHAR;break;
+			default:return 0;
+			}
+		}
+		if(rec->n==YREC_MAX)return 0;
+		rec->type[rec->n]=(unsigned char)t;
+		rec->off[rec->n]=off?off[rec->n]:0;
+		rec->width[rec->n]=width;
+		rec->n++;
+	}
+	return rec->n>0;
+}
+
+/* skips blanks up to the end of the line; returns the next byte or EOF */
+static inline int yskip_blank_r(yreader *r)
+{
+	int c;
+	while((c=ypeek_r(r))!=EOF&&yisblank(c))r->ptr++;
+	return c;
+}
+
+/* consumes the rest of the line, newline included */
+static inline void yskip_line_r(yreader *r)
+{
+	for(;;){
+		char *q=(char*)memchr(r->ptr,'\n',(size_t)(r->end-r->ptr));
+		if(q){r->ptr=q+1;return;}
+		r->ptr=r->end;
+		if(!yrefill_r(r))return;
+	}
+}
+
+static inline int yread_field_r(yreader *r,int type,size_t width,char *p)
+{
+	int c;
+	switch(type){
+	case YFLD_INT:return yread_int_ok_r(r,(int*)p);
+	case YFLD_UINT:return yread_uint_ok_r(r,(unsigned*)p);
+	case YFLD_LL:return yread_ll_ok_r(r,(long long*)p);
+	case YFLD_ULL:return yread_ull_ok_r(r,(unsigned long long*)p);
+	case YFLD_DOUBLE:return yread_double_ok_r(r,(double*)p);
+	case YFLD_STR:return width?yread_strn_ok_r(r,p,width):yread_str_ok_r(r,p);
+	case YFLD_VIEW:return yread_view_ok_r(r,(ystr*)p);
+	default:
+		if((c=yget_r(r))==EOF)return 0;
+		*p=(char)c;
+		YSTAT(r->stats.chars++);
+		return 1;
+	}
+}
+
+/* a bad line is skipped whole so the next record starts on a new line */
+static YCOLD int yrecord_bad_r(yreader *r,int k)
+{
+	yskip_line_r(r);
+	return k;
+}
+
+/*
+ * Parses one line into dst. Returns 0 if the line is complete, k if field
+ * k (1-based) is missing or malformed, n+1 if text follows the last field,
+ * or -1 at EOF. Fields before a bad one are stored; blank lines are skipped.
+ */
+static inline int yread_record_r(yreader *r,const yrecord *rec,void *dst)
+{
+	int i,c;
+	while((c=yskip_blank_r(r))=='\n')r->ptr++;
+	if(c==EOF)return -1;
+	for(i=0;i<rec->n;i++){
+		c=yskip_blank_r(r);
+		if(c==EOF||c=='\n'||!yread_field_r(r,rec->type[i],rec->width[i],(char*)dst+rec->off[i]))
+			return yrecord_bad_r(r,i+1);
+		c=ypeek_r(r);
+		if(c!=EOF&&!yisspace(c))return yrecord_bad_r(r,i+1);
+	}
+	c=yskip_blank_r(r);
+	if(c!=EOF&&c!='\n')return yrecord_bad_r(r,rec->n+1);
+	if(c=='\n')r->ptr++;
+	return 0;
+}
+
+/*
+ * Reads up to n lines into base[0..n) (records rec->size bytes apart).
+ * status, if not NULL, gets each line's yread_record_r() result. Returns
+ * the number of lines read; fewer than n only at EOF.
+ */
+static inline size_t yread_records_r(yreader *r,const yrecord *rec,void *base,size_t n,int *status)
+{
+	size_t i;
+	for(i=0;i<n;i++){
+		int st=yread_record_r(r,rec,(char*)base+i*rec->size);
+		if(st<0)break;
+		if(status)status[i]=st;
+	}
+	return i;
+}
+
+/* ========================= COLUMNS ========================= */
+
+/*
+ * Struct-of-arrays ingestion: a yrecord row schema (offsets unused) and
+ * one output array per field. Rows are whitespace-separated tokens like
+ * the bulk readers, not lines. When every field has the same type the
+ * typed reader runs inline for the whole run; a mixed schema goes through
+ * a per-field reader table built once per call. String
+ * columns need somewhere to live past the next refill, so yread_columns_r()
+ * takes no %s or %S; ycolumns copies them into its arena as ystr.
+ */
+static inline size_t yfield_size(int type)
+{
+	static const unsigned char sz[]={sizeof(int),sizeof(unsigned),sizeof(long long),
+		sizeof(unsigned long long),sizeof(double),sizeof(ystr),sizeof(ystr),1};
+	return sz[type];
+}
+
+#define YCOLUMN_RUN_(T,fn) \
+	for(i=0;i<n;i++) \
+		for(j=0;j<k;j++) \
+			if(!fn(r,(T*)cols[j]+i))return i; \
+	return n
+
+/*
+ * A NULL arena leaves string fields to the caller (yread_columns_r()
+ * rejects them). A mixed schema keeps a switch per cell: a table of
+ * reader pointers measured slower, as the calls stop the typed readers
+ * from inlining, so only the strides and output cursors are set up once.
+ */
+static inline size_t ycolumns_run_r(yreader *r,const yrecord *rec,void *const *cols,size_t n,yarena *a)
+{
+	size_t sz[YREC_MAX],i;
+	char *at[YREC_MAX];
+	int j,k=rec->n,same=1;
+	for(j=0;j<k;j++)same&=rec->type[j]==rec->type[0];
+	if(same)switch(rec->type[0]){
+	case YFLD_INT:YCOLUMN_RUN_(int,yread_int_ok_r);
+	case YFLD_LL:YCOLUMN_RUN_(long long,yread_ll_ok_r);
+	case YFLD_DOUBLE:YCOLUMN_RUN_(double,yread_double_ok_r);
+	default:break;
+	}
+	for(j=0;j<k;j++){
+		sz[j]=yfield_size(rec->type[j]);
+		at[j]=(char*)cols[j];
+	}
+	for(i=0;i<n;i++)
+		for(j=0;j<k;j++){
+			int t=rec->type[j];
+			if(!(t==YFLD_STR||t==YFLD_VIEW?yread_astr_ok_r(r,a,(ystr*)at[j]):yread_field_r(r,t,0,at[j])))return i;
+			at[j]+=sz[j];
+		}
+	return n;
+}
+
+static inline int yrecord_has_str(const yrecord *rec)
+{
+	int j;
+	for(j=0;j<rec->n;j++)
+		if(rec->type[j]==YFLD_STR||rec->type[j]==YFLD_VIEW)return 1;
+	return 0;
+}
+
+/* fills cols[j][0..n); returns the number of complete rows, 0 for a string field */
+static inline size_t yread_columns_r(yreader *r,const yrecord *rec,void *const *cols,size_t n)
+{
+	if(yrecord_has_str(rec))return 0;
+	return ycolumns_run_r(r,rec,cols,n,NULL);
+}
+
+/*
+ * Columns that grow in an arena; col[j] holds rows elements of field j.
+ * %s and %S columns are ystr arrays whose text is copied into the arena.
+ */
+typedef struct ycolumns{
+	yrecord rec;
+	void *col[YREC_MAX];
+	size_t rows,cap;
+	yarena *arena;
+}ycolumns;
+
+static inline int ycolumns_init(ycolumns *t,const char *fmt,yarena *a)
+{
+	memset(t,0,sizeof(*t));
+	if(!yrecord_init(&t->rec,fmt,NULL,0))return 0;
+	t->arena=a;
+	return 1;
+}
+
+static YCOLD int ycolumns_grow(ycolumns *t)
+{
+	size_t cap=t->cap?t->cap*2:1024;
+	int j;
+	for(j=0;j<t->rec.n;j++){
+		size_t sz=yfield_size(t->rec.type[j]);
+		void *p=yarena_grow(t->arena,t->col[j],t->cap*sz,cap*sz);
+		if(!p)return 0;
+		t->col[j]=p;
+	}
+	t->cap=cap;
+	return 1;
+}
+
+/*
+ * Appends up to max rows (0: no limit) and returns how many were added;
+ * it stops early at EOF, on a bad token or when the arena is exhausted.
+ */
+static inline size_t ycolumns_read_r(yreader *r,ycolumns *t,size_t max)
+{
+	size_t total=0;
+	for(;;){
+		void *at[YREC_MAX];
+		size_t want,got;
+		int j;
+		if(t->rows==t->cap&&!ycolumns_grow(t))return total;
+		want=t->cap-t->rows;
+		if(max&&want>max-total)want=max-total;
+		for(j=0;j<t->rec.n;j++)
+			at[j]=(char*)t->col[j]+t->rows*yfield_size(t->rec.type[j]);
+		got=ycolumns_run_r(r,&t->rec,at,want,t->arena);
+		t->rows+=got;
+		total+=got;
+		if(got<want||total==max)return total;
+	}
+}
+
+/* ========================= DELIMITED FIELDS ========================= */
+
+/*
+ * CSV/TSV mode: yreader_set_delim() sets the separator bytes and the quote
+ * byte, and ycsv_field_r() returns one field at a time as a view. Records
+ * end at \n, \r\n or \r. Structural bytes (separators, line ends and the
+ * quote) are found with the scanset kernel, so an unquoted field inside
+ * the buffer is one block scan and no copy; a quoted field without
+ * doubled quotes is a view of its inside. Fields with "" escapes, fields
+ * straddling a refill and prefetch input go through a byte loop that
+ * unescapes into a scratch buffer, valid until the next field.
+ */
+typedef struct ydelim{
+	yset plain;	/* bytes that do not end or quote a field */
+	int quote;	/* quote byte, or -1 */
+	int eol;	/* the last field ended its record */
+	int pending;	/* a separator was consumed: one more field follows */
+	int cr;	/* a \r ended the buffer: drop a \n that follows */
+	char *tmp;
+	size_t tmpcap;
+}ydelim;
+
+static void ydelim_free(ydelim *d)
+{
+	free(d->tmp);
+	free(d);
+}
+
+/* seps: separator bytes (",", "\t", ",;"), NULL for YC_DELIM; quote: e.g. '"', 0 for none */
+static inline int yreader_set_delim(yreader *r,const char *seps,int quote)
+{
+	ydelim *d=r->dl;
+	unsigned c;
+	if(!d){
+		d=(ydelim*)calloc(1,sizeof(*d));
+		if(!d)return 0;
+		r->dl=d;
+	}
+	memset(&d->plain,0,sizeof(d->plain));
+	d->quote=quote?(unsigned char)quote:-1;
+	for(c=0;c<256;c++)
+		if(c!='\n'&&c!='\r'&&(int)c!=d->quote&&
+			!(seps?memchr(seps,(int)c,strlen(seps))!=NULL:(yctype[c]&YC_DELIM)!=0))yset_add(&d->plain,c);
+	yset_stops(&d->plain);
+	d->eol=1;
+	d->pending=d->cr=0;
+	return 1;
+}
+
+/* consumes the separator or line end at ptr, which must not need a refill */
+static inline void ycsv_end_r(yreader *r,ydelim *d)
+{
+	int c;
+	if(r->ptr>=r->end){
+		d->eol=1;
+		d->pending=0;
+		return;
+	}
+	c=(unsigned char)*r->ptr++;
+	d->eol=c=='\n'||c=='\r';
+	d->pending=!d->eol;
+	if(c=='\r'){
+		if(r->ptr<r->end)r->ptr+=*r->ptr=='\n';
+		else d->cr=1;
+	}
+}
+
+static YCOLD int ycsv_put_r(ydelim *d,size_t n,int c)
+{
+	if(n==d->tmpcap){
+		size_t cap=d->tmpcap?d->tmpcap*2:256;
+		char *p=(char*)realloc(d->tmp,cap);
+		if(!p)return 0;
+		d->tmp=p;
+		d->tmpcap=cap;
+	}
+	d->tmp[n]=(char)c;
+	return 1;
+}
+
+static YCOLD int ycsv_slow_r(yreader *r,ydelim *d,ystr *v)
+{
+	size_t n=0;
+	int c,quoted=0;
+	if(ypeek_r(r)==d->quote){
+		quoted=1;
+		r->ptr++;
+	}
+	while((c=ypeek_r(r))!=EOF){
+		if(quoted&&c==d->quote){
+			r->ptr++;
+			if(ypeek_r(r)!=d->quote){
+				quoted=0;
+				continue;
+			}
+		}
+		else if(!quoted&&c!=d->quote&&!yset_has(&d->plain,c))break;
+		if(!ycsv_put_r(d,n,c)){
+			errno=ENOMEM;
+			return 0;
+		}
+		r->ptr++;
+		n++;
+	}
+	v->ptr=d->tmp;
+	v->len=n;
+	ycsv_end_r(r,d);
+	YSTAT(r->stats.strs++);
+	return 1;
+}
+
+/*
+ * 1 and the next field in v, or 0 at EOF; ycsv_eol_r() tells if it ended a
+ * record. 0 with errno ENOMEM if the scratch buffer for an unescaped or
+ * straddling field cannot grow; the byte it stopped at is left unread.
+ */
+static inline int ycsv_field_r(yreader *r,ystr *v)
+{
+	ydelim *d=r->dl;
+	char *p,*q;
+	if(YUNLIKELY(d->cr)){
+		d->cr=0;
+		if(ypeek_r(r)=='\n')r->ptr++;
+	}
+	if(r->ptr>=r->end&&!yrefill_r(r)){
+		if(!d->pending)return 0;
+		v->ptr=r->ptr;
+		v->len=0;
+		d->eol=1;
+		d->pending=0;
+		return 1;
+	}
+	p=r->ptr;
+	if((unsigned char)*p==d->quote){
+		/* a quoted field that closes inside the buffer with no "" in it */
+		q=(char*)memchr(p+1,d->quote,(size_t)(r->end-p-1));
+		if(!q||q+1>=r->end||(unsigned char)q[1]==d->quote||yset_has(&d->plain,q[1]))
+			return ycsv_slow_r(r,d,v);
+		v->ptr=p+1;
+		v->len=(size_t)(q-p-1);
+		r->ptr=q+1;
+		ycsv_end_r(r,d);
+		YSTAT(r->stats.strs++);
+		return 1;
+	}
+	q=yset_span(&d->plain,p,r->end);
+	if(YUNLIKELY(q==r->end)){
+		int whole=r->src==YSRC_MEM;
+#ifdef YSCANF_HAVE_MMAP
+		whole|=r->map_state==1;
+#endif
+		if(!whole)return ycsv_slow_r(r,d,v);
+	}
+	else if(YUNLIKELY((unsigned char)*q==d->quote))return ycsv_slow_r(r,d,v);
+	v->ptr=p;
+	v->len=(size_t)(q-p);
+	r->ptr=q;
+	ycsv_end_r(r,d);
+	YSTAT(r->stats.strs++);
+	return 1;
+}
+
+static inline int ycsv_eol_r(const yreader *r){return r->dl->eol;}
+
+/* parses the whole of v with the reader narrowed to it (no refills) */
+static inline int ycsv_parse_r(yreader *r,const ystr *v,int type,void *out)
+{
+	char *ptr=r->ptr,*end=r->end;
+	int eof=r->eof,src=r->src,pad=r->pad,ok;
+	r->ptr=(char*)v->ptr;
+	r->end=r->ptr+v->len;
+	r->eof=1;
+	r->src=YSRC_MEM;
+	r->pad=0;
+	ok=yread_field_r(r,type,0,(char*)out);
+	if(ok){
+		yskip_space_r(r);
+		ok=r->ptr==r->end;
+	}
+	r->ptr=ptr;
+	r->end=end;
+	r->eof=eof;
+	r->src=src;
+	r->pad=pad;
+	return ok;
+}
+
+/* typed fields: 1 if the field parsed whole, 0 if empty or malformed, EOF at end or on ENOMEM */
+static inline int ycsv_int_r(yreader *r,int *out)
+{
+	ystr v;
+	if(!ycsv_field_r(r,&v))return EOF;
+	return ycsv_parse_r(r,&v,YFLD_INT,out);
+}
+
+static inline int ycsv_ll_r(yreader *r,long long *out)
+{
+	ystr v;
+	if(!ycsv_field_r(r,&v))return EOF;
+	return ycsv_parse_r(r,&v,YFLD_LL,out);
+}
+
+static inline int ycsv_double_r(yreader *r,double *out)
+{
+	ystr v;
+	if(!ycsv_field_r(r,&v))return EOF;
+	return ycsv_parse_r(r,&v,YFLD_DOUBLE,out);
+}
+
+/* ========================= MERGE ========================= */
+
+/*
+ * k-way merge of sorted streams. ymerge_init() takes k readers that have
+ * not been read yet and lends each a slice of one pooled block, sized
+ * budget/k (16 MiB in total for 0) between 4 KiB and YSCANF_BUFFER_SIZE,
+ * so 64 streams do not cost 64 default buffers. Readers over regular
+ * files are mapped as usual and leave their slice unused.
+ *
+ * ymerge_next() returns the stream whose key is smallest (ties go to the
+ * lower index) and stores the key; the rest of that stream's record may
+ * be read from m->r[i] before the next call, which reads its next key.
+ * Returns -1 when every stream is exhausted or off a number. Every 64 keys
+ * the streams close to a refill get a read-ahead hint (fadvise, or madvise
+ * for mappings) so the kernel fetches them together.
+ */
+enum{YKEY_LL,YKEY_ULL,YKEY_DOUBLE};
+
+typedef union ykey{
+	long long ll;
+	unsigned long long ull;
+	double d;
+}ykey;
+
+typedef struct ymerge{
+	yreader *r;	/* the caller's readers, r[0..k) */
+	int k,n,type;
+	int last;	/* stream returned by the previous call, -1 if none */
+	int *heap;	/* stream indices, smallest key first */
+	ykey *key;
+	char **ahead;	/* per stream: end of the window already hinted */
+	char *pool;
+	size_t cap;
+	unsigned pops;
+}ymerge;
+
+static inline int ymerge_init(ymerge *m,yreader *r,int k,int type,size_t budget)
+{
+	int i;
+	memset(m,0,sizeof(*m));
+	if(k<=0)return 0;
+	if(!budget)budget=(size_t)16<<20;
+	m->cap=(budget/(size_t)k)&~(size_t)4095;
+	if(m->cap<4096)m->cap=4096;
+	/* pad first: the slice stays at least 4 KiB even when YSCANF_BUFFER_SIZE is tiny */
+	m->cap-=YSCANF_PAD;
+	if(m->cap>(size_t)YSCANF_BUFFER_SIZE)m->cap=(size_t)YSCANF_BUFFER_SIZE;
+	m->heap=(int*)malloc((size_t)k*sizeof(*m->heap));
+	m->key=(ykey*)malloc((size_t)k*sizeof(*m->key));
+	m->ahead=(char**)calloc((size_t)k,sizeof(*m->ahead));
+	m->pool=(char*)calloc((size_t)k,m->cap+YSCANF_PAD);
+	if(!m->heap||!m->key||!m->ahead||!m->pool){
+		free(m->heap);free(m->key);free(m->ahead);free(m->pool);
+		return 0;
+	}
+	for(i=0;i<k;i++){
+		if(r[i].buf||r[i].end||r[i].eof)continue;
+		r[i].buf=m->pool+(size_t)i*(m->cap+YSCANF_PAD);
+		r[i].cap=m->cap;
+		r[i].buf_kind=YBK_POOL;
+	}
+	m->r=r;
+	m->k=k;
+	m->type=type;
+	m->n=-1;
+	m->last=-1;
+	return 1;
+}
+
+/* once the readers are no longer read; they still need yreader_close() */
+static inline void ymerge_free(ymerge *m)
+{
+	int i;
+	for(i=0;i<m->k;i++)
+		if(m->r[i].buf_kind==YBK_POOL){m->r[i].buf=NULL;m->r[i].buf_kind=YBK_HEAP;}
+	free(m->heap);
+	free(m->key);
+	free(m->ahead);
+	free(m->pool);
+	memset(m,0,sizeof(*m));
+}
+
+static inline int ymerge_less(const ymerge *m,int a,int b)
+{
+	const ykey *x=&m->key[a],*y=&m->key[b];
+	switch(m->type){
+	case YKEY_LL:if(x->ll!=y->ll)return x->ll<y->ll;break;
+	case YKEY_ULL:if(x->ull!=y->ull)return x->ull<y->ull;break;
+	default:if(x->d!=y->d)return x->d<y->d;
+	}
+	return a<b;
+}
+
+static inline int ymerge_key_r(ymerge *m,int i)
+{
+	ykey *k=&m->key[i];
+	switch(m->type){
+	case YKEY_LL:return yread_ll_ok_r(&m->r[i],&k->ll);
+	case YKEY_ULL:return yread_ull_ok_r(&m->r[i],&k->ull);
+	default:return yread_double_ok_r(&m->r[i],&k->d);
+	}
+}
+
+static inline void ymerge_down(ymerge *m,int at)
+{
+	int *h=m->heap,v=h[at];
+	for(;;){
+		int c=2*at+1;
+		if(c>=m->n)break;
+		if(c+1<m->n&&ymerge_less(m,h[c+1],h[c]))c++;
+		if(!ymerge_less(m,h[c],v))break;
+		h[at]=h[c];
+		at=c;
+	}
+	h[at]=v;
+}
+
+static YCOLD void ymerge_readahead(ymerge *m)
+{
+#ifdef YSCANF_HAVE_POSIX
+	int i;
+	for(i=0;i<m->k;i++){
+		yreader *r=&m->r[i];
+		if(r->eof||r->pf||r->src==YSRC_MEM||r->src==YSRC_FN)continue;
+#ifdef YSCANF_HAVE_MMAP
+		if(r->map_state==1){
+			size_t pg=(size_t)sysconf(_SC_PAGESIZE),off,len;
+			if(m->ahead[i]&&r->ptr+m->cap/2<m->ahead[i])continue;
+			off=(size_t)(r->ptr-r->map)&~(pg-1);
+			len=r->maplen-off<m->cap?r->maplen-off:m->cap;
+			posix_madvise(r->map+off,len,POSIX_MADV_WILLNEED);
+			m->ahead[i]=r->map+off+len;
+			continue;
+		}
+#endif
+#ifdef POSIX_FADV_WILLNEED
+		if((size_t)(r->end-r->ptr)<m->cap/4&&m->ahead[i]!=r->end){
+			int fd=ysrc_fd_r(r);
+			off_t off=fd<0?-1:lseek(fd,0,SEEK_CUR);
+			if(off>=0)posix_fadvise(fd,off,(off_t)m->cap,POSIX_FADV_WILLNEED);
+			m->ahead[i]=r->end;
+		}
+#endif
+	}
+#else
+	(void)m;
+#endif
+}
+
+static inline int ymerge_next(ymerge *m,ykey *key)
+{
+	int i;
+	if(YUNLIKELY(m->n<0)){
+		m->n=0;
+		for(i=0;i<m->k;i++)if(ymerge_key_r(m,i))m->heap[m->n++]=i;
+		for(i=m->n/2-1;i>=0;i--)ymerge_down(m,i);
+	}
+	else if(m->last>=0){
+		/* the previous stream moves on to its next key, or leaves */
+		if(!ymerge_key_r(m,m->last))m->heap[0]=m->heap[--m->n];
+		if(m->n)ymerge_down(m,0);
+	}
+	if(YUNLIKELY(!(++m->pops&63)))ymerge_readahead(m);
+	if(!m->n){m->last=-1;return -1;}
+	m->last=i=m->heap[0];
+	*key=m->key[i];
+	return i;
+}
+
+/* ========================= PARALLEL ========================= */
+
+/*
+ * Opt-in (YSCANF_PARALLEL, POSIX, -pthread): yparallel_mem() splits a span
+ * into ceil(len/chunk) chunks, each moved forward to start just after a
+ * delimiter ('\n', or any whitespace when delim is 0), and runs
+ * work(r,i,ctx) on every chunk i with a private memory reader. Chunk i may
+ * be empty. Chunks are dealt out in contiguous runs, one per thread; a
+ * thread that runs dry steals from the back of the fullest run. If emit is
+ * given, emit(i,ctx) is called for chunks in index order, one at a time,
+ * as soon as every earlier chunk is done. A nonzero return from work stops
+ * handing out chunks. Returns the chunk count, or -1 on failure or abort.
+ */
+#if defined(YSCANF_PARALLEL)&&defined(YSCANF_HAVE_POSIX)
+#include <pthread.h>
+
+typedef int (*ypar_work_fn)(yreader *r,size_t chunk,void *ctx);
+typedef void (*ypar_emit_fn)(size_t chunk,void *ctx);
+
+typedef struct ypar_run{
+	unsigned long long range;	/* next chunk in the low half, end in the high half */
+	char pad[56];
+}ypar_run;
+
+typedef struct ypar{
+	const char *p;
+	size_t len,chunk,n;
+	int delim,nrun,stop;
+	ypar_work_fn work;
+	ypar_emit_fn emit;
+	void *ctx;
+	ypar_run *runs;
+	unsigned char *done;
+	size_t next;
+	pthread_mutex_t mu;
+}ypar;
+
+static inline size_t ypar_chunks(size_t len,size_t chunk)
+{
+	return chunk?(len+chunk-1)/chunk:0;
+}
+
+/* first record start at or after chunk i's nominal offset */
+static inline size_t ypar_bound(const ypar *s,size_t i)
+{
+	char *p=(char*)s->p,*q;
+	size_t b=i*s->chunk;
+	if(!b)return 0;
+	if(b>=s->len)return s->len;
+	if(s->delim?p[b-1]==s->delim:yisspace((unsigned char)p[b-1]))return b;
+	if(s->delim)q=(char*)memchr(p+b,s->delim,s->len-b);
+	else if((q=yfind_ws_span(p+b,p+s->len))==p+s->len)q=NULL;
+	return q?(size_t)(q-p)+1:s->len;
+}
+
+/* owner takes from the front of its run, thieves from the back */
+static inline int ypar_take(ypar_run *q,int front,size_t *out)
+{
+	unsigned long long v=__atomic_load_n(&q->range,__ATOMIC_ACQUIRE),nv;
+	for(;;){
+		unsigned lo=(unsigned)v,hi=(unsigned)(v>>32);
+		if(lo>=hi)return 0;
+		if(front){*out=lo;nv=((unsigned long long)hi<<32)|(lo+1);}
+		else{*out=hi-1;nv=((unsigned long long)(hi-1)<<32)|lo;}
+		if(__atomic_compare_exchange_n(&q->range,&v,nv,0,__ATOMIC_ACQ_REL,__ATOMIC_ACQUIRE))return 1;
+	}
+}
+
+static inline int ypar_steal(ypar *s,size_t *out)
+{
+	for(;;){
+		int j,best=-1;
+		unsigned most=0;
+		for(j=0;j<s->nrun;j++){
+			unsigned long long v=__atomic_load_n(&s->runs[j].range,__ATOMIC_RELAXED);
+			unsigned left=(unsigned)(v>>32)-(unsigned)v;
+			if((unsigned)v<(unsigned)(v>>32)&&left>most){most=left;best=j;}
+		}
+		if(best<0)return 0;
+		if(ypar_take(&s->runs[best],0,out))return 1;
+	}
+}
+
+static inline void ypar_one(ypar *s,size_t i)
+{
+	size_t lo=ypar_bound(s,i),hi=ypar_bound(s,i+1);
+	yreader r;
+	yreader_init_mem(&r,s->p+lo,hi>lo?hi-lo:0);
+	if(s->work(&r,i,s->ctx))__atomic_store_n(&s->stop,1,__ATOMIC_RELAXED);
+	if(!s->emit)return;
+	pthread_mutex_lock(&s->mu);
+	s->done[i]=1;
+	while(s->next<s->n&&s->done[s->next]&&!__atomic_load_n(&s->stop,__ATOMIC_RELAXED))
+		s->emit(s->next++,s->ctx);
+	pthread_mutex_unlock(&s->mu);
+}
+
+typedef struct ypar_arg{ypar *s;int id;}ypar_arg;
+
+static void *ypar_main(void *arg)
+{
+	ypar_arg *a=(ypar_arg*)arg;
+	ypar *s=a->s;
+	size_t i;
+	while(!__atomic_load_n(&s->stop,__ATOMIC_RELAXED)){
+		if(!ypar_take(&s->runs[a->id],1,&i)&&!ypar_steal(s,&i))break;
+		ypar_one(s,i);
+	}
+	return NULL;
+}
+
+/* threads<=0: one per online CPU; chunk 0: 8 MiB */
+static YCOLD long yparallel_mem(const void *data,size_t len,int threads,size_t chunk,int delim,
+	ypar_work_fn work,ypar_emit_fn emit,void *ctx)
+{
+	ypar s;
+	pthread_t *thr;
+	ypar_arg *args;
+	int t,started=1;
+	memset(&s,0,sizeof(s));
+	if(!chunk)chunk=(size_t)8<<20;
+	if(threads<=0){
+		long c=sysconf(_SC_NPROCESSORS_ONLN);
+		threads=c>0?(int)c:1;
+	}
+	s.p=(const char*)data;
+	s.len=len;
+	s.chunk=chunk;
+	s.n=ypar_chunks(len,chunk);
+	s.delim=delim;
+	s.work=work;
+	s.emit=emit;
+	s.ctx=ctx;
+	if(s.n>0xffffffffu)return -1;
+	if((size_t)threads>s.n)threads=s.n?(int)s.n:1;
+	s.nrun=threads;
+	s.runs=(ypar_run*)calloc(threads,sizeof(ypar_run));
+	s.done=(unsigned char*)calloc(s.n+1,1);
+	thr=(pthread_t*)malloc(threads*sizeof(pthread_t));
+	args=(ypar_arg*)malloc(threads*sizeof(ypar_arg));
+	if(!s.runs||!s.done||!thr||!args||pthread_mutex_init(&s.mu,NULL)){
+		free(s.runs);free(s.done);free(thr);free(args);
+		return -1;
+	}
+	for(t=0;t<threads;t++){
+		unsigned long long lo=s.n*t/threads,hi=s.n*(t+1)/threads;
+		s.runs[t].range=(hi<<32)|lo;
+		args[t].s=&s;
+		args[t].id=t;
+	}
+	/* the caller is worker 0; runs of threads that fail to start get stolen */
+	for(t=1;t<threads;t++)started+=!pthread_create(&thr[started],NULL,ypar_main,&args[t]);
+	ypar_main(&args[0]);
+	for(t=1;t<started;t++)pthread_join(thr[t],NULL);
+	pthread_mutex_destroy(&s.mu);
+	free(s.runs);free(s.done);free(thr);free(args);
+	return s.stop?-1:(long)s.n;
+}
+
+#ifdef YSCANF_HAVE_MMAP
+/* maps a regular file and runs yparallel_mem() over all of it */
+static YCOLD long yparallel_fd(int fd,int threads,size_t chunk,int delim,
+	ypar_work_fn work,ypar_emit_fn emit,void *ctx)
+{
+	struct stat st;
+	void *p;
+	long n;
+	if(fstat(fd,&st)||!S_ISREG(st.st_mode))return -1;
+	if(!st.st_size)return 0;
+	if((unsigned long long)st.st_size>(size_t)-1)return -1;
+	p=mmap(NULL,(size_t)st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+	if(p==MAP_FAILED)return -1;
+	posix_madvise(p,(size_t)st.st_size,POSIX_MADV_WILLNEED);
+	n=yparallel_mem(p,(size_t)st.st_size,threads,chunk,delim,work,emit,ctx);
+	munmap(p,(size_t)st.st_size);
+	return n;
+}
+#endif
+#endif
+
+/* ========================= YSCANF ========================= */
+
+/*
+ * yvscanf_r() keeps the last few compiled scansets per thread, keyed by
+ * the address and text of the format, so a loop over one format compiles
+ * each set once. Sets longer than YSET_KEY bytes are compiled every call.
+ */
+#define YSET_CACHE 8
+#define YSET_KEY 32
+
+/* compiles or finds the set at fmt; returns its closing ] or NULL */
+static inline const char *yset_lookup(const char *fmt,yset *tmp,const yset **out)
+{
+	const char *end;
+#ifdef YTLS
+	static YTLS struct{const char *key;size_t len;char text[YSET_KEY];yset set;}cache[YSET_CACHE];
+	static YTLS unsigned next;
+	unsigned i;
+	for(i=0;i<YSET_CACHE;i++)
+		if(cache[i].key==fmt&&!strncmp(cache[i].text,fmt,cache[i].len)){
+			*out=&cache[i].set;
+			return fmt+cache[i].len-1;
+		}
+#endif
+	end=yset_compile(tmp,fmt);
+	*out=tmp;
+#ifdef YTLS
+	if(end&&(size_t)(end-fmt)<YSET_KEY){
+		i=next++%YSET_CACHE;
+		cache[i].key=fmt;
+		cache[i].len=(size_t)(end-fmt)+1;
+		memcpy(cache[i].text,fmt,cache[i].len);
+		cache[i].set=*tmp;
+	}
+#endif
+	return end;
+}
+
+/* interprets fmt directly: formats the program cache does not take */
+static inline int yvscanf_slow_r(yreader *r,const char *fmt,va_list ap)
+{
+	int cnt=0;
+	size_t width;
+
+	while(*fmt){
+		if(yisspace((unsigned char)*fmt)){
+			yskip_space_r(r);
+			fmt++;
+			continue;
+		}
+		if(*fmt!='%'){
+			fmt++;
+			continue;
+		}
+		fmt++;
+		/* a width is only supported on %s and %[ */
+		width=0;
+		while(yisdigit((unsigned char)*fmt))width=width*10+(size_t)(*fmt++-'0');
+		if(width&&*fmt!='s'&&*fmt!='[')return -1;
+
+		if(*fmt=='d'){
+			int *p=va_arg(ap,int*);
+			if(!yread_int_ok_r(r,p))return cnt?cnt:EOF;
+			cnt++;
+		}
+		else if(*fmt=='u'){
+			unsigned *p=va_arg(ap,unsigned*);
+			if(!yread_uint_ok_r(r,p))return cnt?cnt:EOF;
+			cnt++;
+		}
+		else if(*fmt=='l'){
+			fmt++;
+			if(*fmt=='l'){
+				fmt++;
+				if(*fmt=='d'){
+					long long *p=va_arg(ap,long long*);
+					if(!yread_ll_ok_r(r,p))return cnt?cnt:EOF;
+					cnt++;
+				}
+				else if(*fmt=='u'){
+					unsigned long long *p=va_arg(ap,unsigned long long*);
+					if(!yread_ull_ok_r(r,p))return cnt?cnt:EOF;
+					cnt++;
+				}
+				else{
+					return -1;
+				}
+			}
+			else if(*fmt=='f'||*fmt=='e'||*fmt=='g'){
+				double *p=va_arg(ap,double*);
+				if(!yread_double_ok_r(r,p))return cnt?cnt:EOF;
+				cnt++;
+			}
+			else{
+				return -1;
+			}
+		}
+		else if(*fmt=='f'||*fmt=='e'||*fmt=='g'){
+			double *p=va_arg(ap,double*);
+			if(!yread_double_ok_r(r,p))return cnt?cnt:EOF;
+			cnt++;
+		}
+		else if(*fmt=='s'){
+			char *p=va_arg(ap,char*);
+			if(!(width?yread_strn_ok_r(r,p,width):yread_str_ok_r(r,p)))return cnt?cnt:EOF;
+			cnt++;
+		}
+		else if(*fmt=='['){
+			yset tmp;
+			const yset *set;
+			char *p;
+			fmt=yset_lookup(fmt,&tmp,&set);
+			if(!fmt)return -1;
+			p=va_arg(ap,char*);
+			if(!yread_set_ok_r(r,set,p,width?width:(size_t)-1))return cnt?cnt:EOF;
+			cnt++;
+		}
+		else if(*fmt=='S'){
+			ystr *p=va_arg(ap,ystr*);
+			if(!yread_view_ok_r(r,p))return cnt?cnt:EOF;
+			cnt++;
+		}
+		else if(*fmt=='c'){
+			char *p=va_arg(ap,char*);
+			int c=yget_r(r);
+			if(c==EOF)return cnt?cnt:EOF;
+			*p=(char)c;
+			YSTAT(r->stats.chars++);
+			cnt++;
+		}
+		else{
+			return -1;
+		}
+		fmt++;
+	}
+
+	return cnt;
+}
+
+/*
+ * Compiled formats: the first yvscanf_r() call with a format turns it into
+ * an opcode program, kept in a small per-thread cache keyed like the set
+ * cache: a hit needs the same pointer and the same text, so every call still
+ * strncmp()s fmt against the stored copy (up to YFMT_KEY bytes; the last
+ * format used is tried before the others) and a buffer rewritten in place
+ * is compiled afresh. The program then runs without parsing fmt again.
+ * With GCC/clang the program is dispatched by computed goto. Formats
+ * longer than YFMT_KEY bytes, with more than YFMT_OPS conversions or
+ * YFMT_SETS scansets, or malformed ones go through yvscanf_slow_r(), as do
+ * calls nested in a callback source, which could evict the running program.
+ * A format that does not compile is cached too, as slow, so a loop over it
+ * costs one lookup per call and does not evict the live programs.
+ */
+#define YFMT_CACHE 16
+#define YFMT_KEY 64
+#define YFMT_OPS 32
+#define YFMT_SETS 2
+
+enum{YOP_END,YOP_SKIP,YOP_I32,YOP_U32,YOP_I64,YOP_U64,YOP_F64,YOP_STR,YOP_STRN,YOP_SET,YOP_VIEW,YOP_CHR};
+
+typedef struct yfmt{
+	unsigned char op[YFMT_OPS+1];
+	unsigned arg[YFMT_OPS];	/* %Ns width; %[ width and set slot */
+	yset set[YFMT_SETS];
+}yfmt;
+
+/* 1 if fmt fits a program; 0 leaves it to yvscanf_slow_r() */
+static inline int yfmt_compile(yfmt *p,const char *fmt)
+{
+	int n=0,ns=0;
+	while(*fmt){
+		size_t width=0;
+		unsigned char o;
+		if(yisspace((unsigned char)*fmt)){
+			if(!n||p->op[n-1]!=YOP_SKIP){
+				if(n==YFMT_OPS)return 0;
+				p->op[n++]=YOP_SKIP;
+			}
+			fmt++;
+			continue;
+		}
+		if(*fmt++!='%')continue;
+		while(yisdigit((unsigned char)*fmt))width=width*10+(size_t)(*fmt++-'0');
+		if(width>=0xFFFFFFu||(width&&*fmt!='s'&&*fmt!='['))return 0;
+		switch(*fmt){
+		case 'd':o=YOP_I32;break;
+		case 'u':o=YOP_U32;break;
+		case 'f':case 'e':case 'g':o=YOP_F64;break;
+		case 's':o=width?YOP_STRN:YOP_STR;break;
+		case 'S':o=YOP_VIEW;break;
+		case 'c':o=YOP_CHR;break;
+		case '[':
+			if(ns==YFMT_SETS||!(fmt=yset_compile(&p->set[ns],fmt)))return 0;
+			o=YOP_SET;
+			width=(width?width:0xFFFFFFu)<<8|(unsigned)ns++;
+			break;
+		case 'l':
+			fmt++;
+			if(*fmt=='f'||*fmt=='e'||*fmt=='g'){o=YOP_F64;break;}
+			if(*fmt++!='l')return 0;
+			if(*fmt=='d'){o=YOP_I64;break;}
+			if(*fmt=='u'){o=YOP_U64;break;}
+			return 0;
+		default:return 0;
+		}
+		if(n==YFMT_OPS)return 0;
+		p->arg[n]=(unsigned)width;
+		p->op[n++]=o;
+		fmt++;
+	}
+	p->op[n]=YOP_END;
+	return 1;
+}
+
+#if (defined(__GNUC__)||defined(__clang__))&&!defined(YSCANF_NO_CGOTO)
+#define YFMT_CGOTO 1
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+static inline int yfmt_run_r(yreader *r,const yfmt *p,va_list ap)
+{
+	int cnt=0,i=0;
+#ifdef YFMT_CGOTO
+	static const void *const tab[]={&&o_END,&&o_SKIP,&&o_I32,&&o_U32,&&o_I64,&&o_U64,
+		&&o_F64,&&o_STR,&&o_STRN,&&o_SET,&&o_VIEW,&&o_CHR};
+#define YOP(x) o_##x
+#define YNEXT goto *tab[p->op[i++]]
+	YNEXT;
+#else
+#define YOP(x) case YOP_##x
+#define YNEXT continue
+	for(;;)switch(p->op[i++]){
+#endif
+	YOP(SKIP):
+		yskip_space_r(r);
+		YNEXT;
+	YOP(I32):
+		if(!yread_int_ok_r(r,va_arg(ap,int*)))goto fail;
+		cnt++;
+		YNEXT;
+	YOP(U32):
+		if(!yread_uint_ok_r(r,va_arg(ap,unsigned*)))goto fail;
+		cnt++;
+		YNEXT;
+	YOP(I64):
+		if(!yread_ll_ok_r(r,va_arg(ap,long long*)))goto fail;
+		cnt++;
+		YNEXT;
+	YOP(U64):
+		if(!yread_ull_ok_r(r,va_arg(ap,unsigned long long*)))goto fail;
+		cnt++;
+		YNEXT;
+	YOP(F64):
+		if(!yread_double_ok_r(r,va_arg(ap,double*)))goto fail;
+		cnt++;
+		YNEXT;
+	YOP(STR):
+		if(!yread_str_ok_r(r,va_arg(ap,char*)))goto fail;
+		cnt++;
+		YNEXT;
+	YOP(STRN):
+		if(!yread_strn_ok_r(r,va_arg(ap,char*),p->arg[i-1]))goto fail;
+		cnt++;
+		YNEXT;
+	YOP(SET):{
+		unsigned a=p->arg[i-1];
+		size_t w=a>>8==0xFFFFFFu?(size_t)-1:a>>8;
+		if(!yread_set_ok_r(r,&p->set[a&255],va_arg(ap,char*),w))goto fail;
+		cnt++;
+		YNEXT;
+	}
+	YOP(VIEW):
+		if(!yread_view_ok_r(r,va_arg(ap,ystr*)))goto fail;
+		cnt++;
+		YNEXT;
+	YOP(CHR):{
+		char *c=va_arg(ap,char*);
+		int v=yget_r(r);
+		if(v==EOF)goto fail;
+		*c=(char)v;
+		YSTAT(r->stats.chars++);
+		cnt++;
+		YNEXT;
+	}
+	YOP(END):
+		return cnt;
+#ifndef YFMT_CGOTO
+	}
+#endif
+#undef YOP
+#undef YNEXT
+fail:
+	return cnt?cnt:EOF;
+}
+
+#ifdef YFMT_CGOTO
+#pragma GCC diagnostic pop
+#endif
+
+static inline int yvscanf_r(yreader *r,const char *fmt,va_list ap)
+{
+#ifdef YTLS
+	static YTLS struct{const char *key;size_t len;int slow;char text[YFMT_KEY];yfmt prog;}cache[YFMT_CACHE];
+	static YTLS unsigned next,last,depth;
+	int hit=-1;
+	size_t len;
+	unsigned i;
+	/* the same format as last time is by far the common case */
+	if(YUNLIKELY(depth))return yvscanf_slow_r(r,fmt,ap);
+	if(cache[last].key==fmt&&!strncmp(cache[last].text,fmt,cache[last].len))
+		hit=(int)last;
+	for(i=0;hit<0&&i<YFMT_CACHE;i++)
+		if(cache[i].key==fmt&&!strncmp(cache[i].text,fmt,cache[i].len)){
+			last=i;
+			hit=(int)i;
+		}
+	if(hit<0&&(len=strlen(fmt)+1)<=YFMT_KEY){
+		yfmt prog;
+		int ok=yfmt_compile(&prog,fmt);
+		i=next++%YFMT_CACHE;
+		cache[i].key=fmt;
+		cache[i].len=len;
+		cache[i].slow=!ok;
+		memcpy(cache[i].text,fmt,len);
+		if(ok)cache[i].prog=prog;
+		last=i;
+		hit=(int)i;
+	}
+	if(hit>=0&&!cache[hit].slow){
+		int ret;
+		depth++;
+		ret=yfmt_run_r(r,&cache[hit].prog,ap);
+		depth--;
+		return ret;
+	}
+#endif
+	return yvscanf_slow_r(r,fmt,ap);
+}
+
+static inline int yscanf_r(yreader *r,const char *fmt,...)
+{
+	va_list ap;
+	int ret;
+	va_start(ap,fmt);
+	ret=yvscanf_r(r,fmt,ap);
+	va_end(ap);
+	return ret;
+}
+
+static inline int yscanf(const char *fmt,...)
+{
+	va_list ap;
+	int ret;
+	va_start(ap,fmt);
+	ret=yvscanf_r(&ystd_reader,fmt,ap);
+	va_end(ap);
+	return ret;
+}
+
+/* ========================= DEFAULT READER ========================= */
+
+/* forget buffered input and EOF, e.g. after freopen() on stdin */
+static inline void yscanf_reset(void){yreader_close(&ystd_reader);}
+
+static inline int yget(void){return yget_r(&ystd_reader);}
+static inline int ypeek(void){return ypeek_r(&ystd_reader);}
+static inline void yskip_space(void){yskip_space_r(&ystd_reader);}
+static inline void ymark(void){yreader_mark(&ystd_reader);}
+static inline int yrewind(void){return yreader_rewind(&ystd_reader);}
+static inline void yunmark(void){yreader_unmark(&ystd_reader);}
+static inline int yread_int_ok(int *out){return yread_int_ok_r(&ystd_reader,out);}
+static inline int yread_astr_ok(yarena *a,ystr *out){return yread_astr_ok_r(&ystd_reader,a,out);}
+static inline int yread_intern_ok(yintern *t,ystr *out,int *id){return yread_intern_ok_r(&ystd_reader,t,out,id);}
+static inline int yread_uint_ok(unsigned *out){return yread_uint_ok_r(&ystd_reader,out);}
+static inline int yread_ll_ok(long long *out){return yread_ll_ok_r(&ystd_reader,out);}
+static inline int yread_ull_ok(unsigned long long *out){return yread_ull_ok_r(&ystd_reader,out);}
+static inline int yread_int_ovf(int *out,int pol){return yread_int_ovf_r(&ystd_reader,out,pol);}
+static inline int yread_uint_ovf(unsigned *out,int pol){return yread_uint_ovf_r(&ystd_reader,out,pol);}
+static inline int yread_ll_ovf(long long *out,int pol){return yread_ll_ovf_r(&ystd_reader,out,pol);}
+static inline int yread_ull_ovf(unsigned long long *out,int pol){return yread_ull_ovf_r(&ystd_reader,out,pol);}
+static inline int yread_double_ok(double *out){return yread_double_ok_r(&ystd_reader,out);}
+static inline int yread_str_ok(char *s){return yread_str_ok_r(&ystd_reader,s);}
+static inline int yread_strn_ok(char *s,size_t width){return yread_strn_ok_r(&ystd_reader,s,width);}
+static inline int yread_set_ok(const yset *set,char *s,size_t width){return yread_set_ok_r(&ystd_reader,set,s,width);}
+static inline int yread_view_ok(ystr *v){return yread_view_ok_r(&ystd_reader,v);}
+static inline int yread_line_ok(char *s,int maxlen){return yread_line_ok_r(&ystd_reader,s,maxlen);}
+static inline int ygetline_ok(char *s,int maxlen){return ygetline_ok_r(&ystd_reader,s,maxlen);}
+static inline size_t yread_int_array(int *out,size_t n){return yread_int_array_r(&ystd_reader,out,n);}
+static inline size_t yread_ll_array(long long *out,size_t n){return yread_ll_array_r(&ystd_reader,out,n);}
+static inline size_t yread_double_array(double *out,size_t n){return yread_double_array_r(&ystd_reader,out,n);}
+static inline int yread_record(const yrecord *rec,void *dst){return yread_record_r(&ystd_reader,rec,dst);}
+static inline size_t yread_records(const yrecord *rec,void *base,size_t n,int *status){return yread_records_r(&ystd_reader,rec,base,n,status);}
+static inline size_t yread_columns(const yrecord *rec,void *const *cols,size_t n){return yread_columns_r(&ystd_reader,rec,cols,n);}
+static inline size_t ycolumns_read(ycolumns *t,size_t max){return ycolumns_read_r(&ystd_reader,t,max);}
+static inline int ycsv_field(ystr *v){return ycsv_field_r(&ystd_reader,v);}
+static inline int ycsv_eol(void){return ycsv_eol_r(&ystd_reader);}
+static inline int ycsv_int(int *out){return ycsv_int_r(&ystd_reader,out);}
+static inline int ycsv_ll(long long *out){return ycsv_ll_r(&ystd_reader,out);}
+static inline int ycsv_double(double *out){return ycsv_double_r(&ystd_reader,out);}
+
+/* ========================= STATS ACCESS ========================= */
+
+static inline const ystats *yreader_stats(const yreader *r)
+{
+	return &r->stats;
+}
+
+static inline void yreader_stats_dump(const yreader *r,FILE *out)
+{
+	const ystats *st=&r->stats;
+#ifndef YSCANF_STATS
+	fprintf(out,"yscanf: built without YSCANF_STATS, no counters\n");
+	(void)st;
+#else
+	double ms=st->read_ns/1e6;
+	fprintf(out,"yscanf: %llu refills, %llu bytes in %.3f ms (%.1f MB/s)\n",
+		st->refills,st->bytes,ms,ms>0?st->bytes/ms/1e3:0.0);
+	fprintf(out,"yscanf: tokens %%d %llu, %%lld %llu, %%f %llu, %%s %llu, %%c %llu\n",
+		st->ints,st->lls,st->doubles,st->strs,st->chars);
+	fprintf(out,"yscanf: %llu straddled a refill, %llu whitespace bytes skipped\n",
+		st->straddles,st->ws_bytes);
+#endif
+}
+
+static inline void yscanf_stats_dump(void){yreader_stats_dump(&ystd_reader,stderr);}
+
+/* ========================= TYPE-GENERIC ========================= */
+
+/*
+ * C11 counterpart of yscanf.hpp: YSCAN(&n,&x,str) reads each argument by
+ * its pointer type (int, unsigned, long long, unsigned long long, double,
+ * char* string, ystr* view) with no format string to interpret. Each reader skips
+ * leading whitespace. Returns the number read, or EOF if the first one
+ * fails. Up to 8 arguments; r is evaluated once per argument.
+ */
+#if defined(__STDC_VERSION__)&&__STDC_VERSION__>=201112L&&!defined(__cplusplus)
+#define yread_any_r(r,p) _Generic((p), \
+	int*:yread_int_ok_r, \
+	unsigned*:yread_uint_ok_r, \
+	long long*:yread_ll_ok_r, \
+	unsigned long long*:yread_ull_ok_r, \
+	double*:yread_double_ok_r, \
+	char*:yread_str_ok_r, \
+	ystr*:yread_view_ok_r)(r,p)
+
+#define YSCAN_1_(r,a)     (yread_any_r(r,a)?1:0)
+#define YSCAN_2_(r,a,...) (yread_any_r(r,a)?1+YSCAN_1_(r,__VA_ARGS__):0)
+#define YSCAN_3_(r,a,...) (yread_any_r(r,a)?1+YSCAN_2_(r,__VA_ARGS__):0)
+#define YSCAN_4_(r,a,...) (yread_any_r(r,a)?1+YSCAN_3_(r,__VA_ARGS__):0)
+#define YSCAN_5_(r,a,...) (yread_any_r(r,a)?1+YSCAN_4_(r,__VA_ARGS__):0)
+#define YSCAN_6_(r,a,...) (yread_any_r(r,a)?1+YSCAN_5_(r,__VA_ARGS__):0)
+#define YSCAN_7_(r,a,...) (yread_any_r(r,a)?1+YSCAN_6_(r,__VA_ARGS__):0)
+#define YSCAN_8_(r,a,...) (yread_any_r(r,a)?1+YSCAN_7_(r,__VA_ARGS__):0)
+#define YSCAN_PICK_(_1,_2,_3,_4,_5,_6,_7,_8,N,...) N
+
+static inline int yscan_ret_(int n){return n?n:EOF;}
+
+#define YSCAN_R(r,...) yscan_ret_(YSCAN_PICK_(__VA_ARGS__,YSCAN_8_,YSCAN_7_,YSCAN_6_, \
+	YSCAN_5_,YSCAN_4_,YSCAN_3_,YSCAN_2_,YSCAN_1_,~)(r,__VA_ARGS__))
+#define YSCAN(...) YSCAN_R(&ystd_reader,__VA_ARGS__)
+#endif
+
+#endif /* YSCANF_H */
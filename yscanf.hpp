@@ -0,0 +1,301 @@
+/**
+ * @file yscanf.hpp
+ * @brief Compile-time specialized yscanf for C++17
+ * @author Summer PLUS Studio
+ * @email yuzhouhunter@outlook.com
+ * @version 3.0
+ *
+ * YSCANF("%d %lf %s", &n, &x, str) parses the format at compile time and
+ * expands into a straight sequence of yread_*_ok_r() calls: no format
+ * interpretation, no va_arg, and every argument is type-checked against
+ * its specifier. Return values follow yscanf(): the number of items read,
+ * or EOF if the first conversion fails. A malformed format or a wrong
+ * argument type is a compile error.
+ *
+ * Formats follow yscanf(): whitespace skips input whitespace, other
+ * literal characters are ignored, and the specifiers are %d %u %lld %llu
+ * %f %e %g (double*, with or without 'l'), %s and %Ns (char*), %[...]
+ * and %N[...] (char*), %S (ystr*) and %c (char*). Scansets are compiled
+ * into their lookup tables at compile time too.
+ * With C++20 the format can also be passed directly:
+ * ys::scan<"%d %lf">(&n, &x).
+ */
+
+#ifndef YSCANF_HPP
+#define YSCANF_HPP
+
+#include "yscanf.h"
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ys {
+namespace detail {
+
+enum class op : char { skip, i32, u32, i64, u64, f64, str, set, view, chr, bad };
+
+constexpr bool is_space(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+constexpr std::size_t length(const char *s)
+{
+    std::size_t n = 0;
+    while (s[n]) n++;
+    return n;
+}
+
+constexpr void set_add(yset &s, unsigned c)
+{
+    s.bits[c >> 3] |= (unsigned char)(1u << (c & 7));
+    if (c < 128) s.lo[c & 15] |= (unsigned char)(1u << (c >> 4));
+    else s.hi[c & 15] |= (unsigned char)(1u << ((c >> 4) - 8));
+}
+
+constexpr bool set_has(const yset &s, unsigned c)
+{
+    return (s.bits[c >> 3] >> (c & 7) & 1) != 0;
+}
+
+/* same as yset_stops(): the runs of non-members, for the SSE2 kernel */
+constexpr void set_stops(yset &s)
+{
+    unsigned c = 0, n = 0;
+    s.nstop = 0;
+    while (c < 256) {
+        if (set_has(s, c)) {
+            c++;
+            continue;
+        }
+        if (n == YSET_STOPS) return;
+        unsigned a = c;
+        while (c < 256 && !set_has(s, c)) c++;
+        s.stop[n] = (unsigned char)a;
+        s.slen[n] = (unsigned char)(c - 1 - a);
+        n++;
+    }
+    for (c = n; n && c < YSET_STOPS; c++) {
+        s.stop[c] = s.stop[0];
+        s.slen[c] = s.slen[0];
+    }
+    s.nstop = (unsigned char)n;
+}
+
+/* same rules as yset_compile(); f[i] is the '[', returns the closing ']' or 0 */
+constexpr std::size_t compile_set(yset &s, const char *f, std::size_t i)
+{
+    bool mem[256] = {};
+    bool neg = false;
+    i++;
+    if (f[i] == '^') {
+        neg = true;
+        i++;
+    }
+    if (f[i] == ']') mem[(unsigned char)f[i++]] = true;
+    for (; f[i] && f[i] != ']'; i++) {
+        unsigned c = (unsigned char)f[i], hi = (unsigned char)f[i + 2];
+        if (f[i + 1] == '-' && hi && hi != ']' && hi >= c) {
+            for (; c <= hi; c++) mem[c] = true;
+            i += 2;
+        } else {
+            mem[c] = true;
+        }
+    }
+    if (!f[i]) return 0;
+    for (unsigned c = 0; c < 256; c++)
+        if (mem[c] != neg) set_add(s, c);
+    set_stops(s);
+    return i;
+}
+
+/* A compiled format: ops[0..size) with the argument index of each op */
+template <std::size_t N>
+struct program {
+    op ops[N + 1] = {};
+    std::size_t arg[N + 1] = {};
+    std::size_t width[N + 1] = {};
+    yset set[N + 1] = {};
+    std::size_t size = 0;
+    std::size_t nargs = 0;
+    bool ok = true;
+};
+
+template <std::size_t N>
+constexpr program<N> compile(const char *f)
+{
+    program<N> p;
+    std::size_t i = 0;
+    while (f[i]) {
+        if (is_space(f[i])) {
+            /* a run of format whitespace is one skip */
+            if (!p.size || p.ops[p.size - 1] != op::skip) p.ops[p.size++] = op::skip;
+            i++;
+            continue;
+        }
+        if (f[i] != '%') {
+            i++;
+            continue;
+        }
+        i++;
+        std::size_t w = 0;
+        while (f[i] >= '0' && f[i] <= '9') w = w * 10 + (std::size_t)(f[i++] - '0');
+        op o = op::bad;
+        if (w && f[i] != 's' && f[i] != '[') o = op::bad;
+        else if (f[i] == 'd') o = op::i32;
+        else if (f[i] == 'u') o = op::u32;
+        else if (f[i] == 'f' || f[i] == 'e' || f[i] == 'g') o = op::f64;
+        else if (f[i] == 's') o = op::str;
+        else if (f[i] == '[') {
+            std::size_t e = compile_set(p.set[p.size], f, i);
+            if (e) {
+                o = op::set;
+                i = e;
+            }
+        }
+        else if (f[i] == 'S') o = op::view;
+        else if (f[i] == 'c') o = op::chr;
+        else if (f[i] == 'l') {
+            i++;
+            if (f[i] == 'f' || f[i] == 'e' || f[i] == 'g') o = op::f64;
+            else if (f[i] == 'l') {
+                i++;
+                if (f[i] == 'd') o = op::i64;
+                else if (f[i] == 'u') o = op::u64;
+            }
+        }
+        if (o == op::bad) {
+            p.ok = false;
+            return p;
+        }
+        p.arg[p.size] = p.nargs++;
+        p.width[p.size] = w;
+        p.ops[p.size++] = o;
+        i++;
+    }
+    return p;
+}
+
+template <class F>
+inline constexpr program<length(F::s())> prog = compile<length(F::s())>(F::s());
+
+template <op O, class T, class Want>
+constexpr void check_arg()
+{
+    static_assert(std::is_same<T, Want>::value, "yscanf.hpp: argument type does not match its specifier");
+}
+
+/* runs op J; returns false to stop at the first failed conversion */
+template <class F, std::size_t J, class Tuple>
+inline bool step(yreader *r, int &cnt, Tuple &args)
+{
+    constexpr op o = prog<F>.ops[J];
+    if constexpr (o == op::skip) {
+        yskip_space_r(r);
+        return true;
+    } else {
+        auto p = std::get<prog<F>.arg[J]>(args);
+        using T = decltype(p);
+        bool ok;
+        if constexpr (o == op::i32) {
+            check_arg<o, T, int *>();
+            ok = yread_int_ok_r(r, p);
+        } else if constexpr (o == op::u32) {
+            check_arg<o, T, unsigned *>();
+            ok = yread_uint_ok_r(r, p);
+        } else if constexpr (o == op::i64) {
+            check_arg<o, T, long long *>();
+            ok = yread_ll_ok_r(r, p);
+        } else if constexpr (o == op::u64) {
+            check_arg<o, T, unsigned long long *>();
+            ok = yread_ull_ok_r(r, p);
+        } else if constexpr (o == op::f64) {
+            check_arg<o, T, double *>();
+            ok = yread_double_ok_r(r, p);
+        } else if constexpr (o == op::str) {
+            check_arg<o, T, char *>();
+            constexpr std::size_t w = prog<F>.width[J];
+            if constexpr (w != 0) ok = yread_strn_ok_r(r, p, w);
+            else ok = yread_str_ok_r(r, p);
+        } else if constexpr (o == op::set) {
+            check_arg<o, T, char *>();
+            constexpr std::size_t w = prog<F>.width[J];
+            ok = yread_set_ok_r(r, &prog<F>.set[J], p, w != 0 ? w : (std::size_t)-1);
+        } else if constexpr (o == op::view) {
+            check_arg<o, T, ystr *>();
+            ok = yread_view_ok_r(r, p);
+        } else {
+            check_arg<o, T, char *>();
+            int c = yget_r(r);
+            ok = c != EOF;
+            if (ok) *p = (char)c;
+            YSTAT(r->stats.chars += ok);
+        }
+        cnt += ok;
+        return ok;
+    }
+}
+
+template <class F, class Tuple, std::size_t... J>
+inline int run(yreader *r, Tuple &args, std::index_sequence<J...>)
+{
+    int cnt = 0;
+    (void)(step<F, J>(r, cnt, args) && ...);
+    return cnt ? cnt : EOF;
+}
+
+}  // namespace detail
+
+/* F::s() returns the format literal; use the YSCANF/YSCANF_R macros */
+template <class F, class... A>
+inline int scan(yreader *r, A *...args)
+{
+    constexpr auto &p = detail::prog<F>;
+    static_assert(p.ok, "yscanf.hpp: unsupported format specifier");
+    static_assert(p.nargs == sizeof...(A), "yscanf.hpp: argument count does not match the format");
+    std::tuple<A *...> t(args...);
+    return detail::run<F>(r, t, std::make_index_sequence<p.size>{});
+}
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+template <std::size_t N>
+struct fmt {
+    char s[N] = {};
+    constexpr fmt(const char (&str)[N])
+    {
+        for (std::size_t i = 0; i < N; i++) s[i] = str[i];
+    }
+};
+
+namespace detail {
+template <fmt S>
+struct literal {
+    static constexpr const char *s() { return S.s; }
+};
+}  // namespace detail
+
+template <fmt S, class... A>
+inline int scan(yreader *r, A *...args)
+{
+    return scan<detail::literal<S>>(r, args...);
+}
+
+template <fmt S, class... A>
+inline int scan(A *...args)
+{
+    return scan<detail::literal<S>>(ystdin(), args...);
+}
+#endif
+
+}  // namespace ys
+
+#define YSCANF_R(r, fmt, ...)                                          \
+    ([&] {                                                             \
+        struct ys_fmt_ {                                               \
+            static constexpr const char *s() { return fmt; }           \
+        };                                                             \
+        return ::ys::scan<ys_fmt_>(r, __VA_ARGS__);                    \
+    }())
+
+#define YSCANF(fmt, ...) YSCANF_R(ystdin(), fmt, __VA_ARGS__)
+
+#endif /* YSCANF_HPP */